@@ -8,17 +8,19 @@
 
 #include "../include/Channel.hpp"
 #include "../include/Client.hpp"
+#include "../include/Replies.hpp"
 #include "../include/Server.hpp"
 
 /**
  * @brief Sends a message to the specified client, appending CRLF at the end.
+ * @param server Pointer to the server instance.
  * @param fd File descriptor of the target client.
  * @param msg The message to send (without CRLF).
  */
-static void sendToClient(int fd, const std::string& msg)
+static void sendToClient(Server* server, int fd, const std::string& msg)
 {
     std::string withCrLf = msg + "\r\n";
-    send(fd, withCrLf.c_str(), withCrLf.size(), 0);
+    server->safeSend(fd, withCrLf);
 }
 
 static std::string getRandom8BallAnswer()
@@ -187,57 +189,49 @@ static std::string rollDice(int N, int M)
  * @brief Handles the BOT command, parsing the subcommand and dispatching.
  * @param server Pointer to the Server instance.
  * @param fd File descriptor of the client.
- * @param tokens Tokenized command parts.
- * @param fullCommand Original command string (unused).
+ * @param msg The parsed command.
  */
-void handleBotCommand(Server* server, int fd,
-    const std::vector<std::string>& tokens,
-    const std::string& /*fullCommand*/)
+void handleBotCommand(Server* server, int fd, const IrcMessage& msg)
 {
-    (void)server;
-    if (tokens.size() < 2) {
-        sendToClient(fd, "461 BOT :Not enough parameters");
-        return;
-    }
-
-    std::string subCommand = tokens[1];
+    std::string subCommand(msg.params[0]);
     std::transform(subCommand.begin(), subCommand.end(), subCommand.begin(),
         ::toupper);
 
     if (subCommand == "HELP") {
-        sendToClient(fd, getHelpMessage());
+        sendToClient(server, fd, getHelpMessage());
     } else if (subCommand == "JOKE") {
-        sendToClient(fd, getRandomJoke());
+        sendToClient(server, fd, getRandomJoke());
     } else if (subCommand == "FACT") {
-        sendToClient(fd, getRandomFact());
+        sendToClient(server, fd, getRandomFact());
     } else if (subCommand == "TIME") {
         std::string t = getServerTime();
-        sendToClient(fd, "Server local time: " + t);
+        sendToClient(server, fd, "Server local time: " + t);
     } else if (subCommand == "8BALL") {
-        if (tokens.size() < 3) {
-            sendToClient(
-                fd, "461 BOT 8BALL :Not enough parameters (ask a question!)");
+        if (msg.paramCount < 2) {
+            Reply(server, fd, ERR_NEEDMOREPARAMS).param("BOT").param("8BALL")
+                .text("Not enough parameters (ask a question!)").send();
             return;
         }
         std::string question;
-        for (size_t i = 2; i < tokens.size(); ++i) {
-            if (i > 2)
+        for (size_t i = 1; i < msg.paramCount; ++i) {
+            if (i > 1)
                 question += " ";
-            question += tokens[i];
+            question += msg.params[i];
         }
         std::string answer = getRandom8BallAnswer();
-        sendToClient(fd, "Magic 8-Ball says: " + answer);
+        sendToClient(server, fd, "Magic 8-Ball says: " + answer);
     } else if (subCommand == "ROLL") {
         int N = 1, M = 6;
-        if (tokens.size() >= 3) {
-            if (!parseDice(tokens[2], N, M)) {
-                sendToClient(fd, "Usage: BOT ROLL [NdM], e.g. BOT ROLL 2d20");
+        if (msg.paramCount >= 2) {
+            if (!parseDice(std::string(msg.params[1]), N, M)) {
+                sendToClient(server, fd, "Usage: BOT ROLL [NdM], e.g. BOT ROLL 2d20");
                 return;
             }
         }
         std::string result = rollDice(N, M);
-        sendToClient(fd, result);
+        sendToClient(server, fd, result);
     } else {
-        sendToClient(fd, "421 BOT " + subCommand + " :Unknown BOT subcommand");
+        Reply(server, fd, ERR_UNKNOWNCOMMAND).param("BOT").param(subCommand)
+            .text("Unknown BOT subcommand").send();
     }
 }
@@ -1,13 +1,10 @@
 #ifndef BOTCOMMAND_HPP
 #define BOTCOMMAND_HPP
 
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 class Server;
 
-void handleBotCommand(Server* server, int fd,
-                      const std::vector<std::string>& tokens,
-                      const std::string&              fullCommand);
+void handleBotCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif
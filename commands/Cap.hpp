@@ -1,8 +1,7 @@
 #ifndef CAP_HPP
 #define CAP_HPP
 
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 class Server;
 
@@ -21,9 +20,8 @@ class Server;
  *
  * @param server  Pointer to the Server object.
  * @param fd      File descriptor of the client sending the command.
- * @param tokens  The tokenized command arguments.
- * @param command The full command string as received from the client.
+ * @param msg     The parsed command (`CAP <subcommand> [:<capabilities>]`).
  */
-void handleCapCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handleCapCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // CAP_HPP
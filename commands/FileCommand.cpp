@@ -9,6 +9,8 @@
 
 #include "../include/Client.hpp"
 #include "../include/FileTransfer.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Replies.hpp"
 #include "../include/Utils.hpp"
 
 /**
@@ -17,205 +19,187 @@
 static std::vector<char> base64Decode(const std::string& in);
 
 /**
- * @brief Generates a unique key in the format "fd_filename" for storing a FileTransfer.
+ * @brief Generates a unique key in the format "senderId_filename" for storing a FileTransfer.
+ *
+ * Keyed by handle, so a transfer left behind by a departed sender can never be
+ * continued by the next connection on the same descriptor.
  */
-static std::string makeTransferKey(int senderFd, const std::string& filename)
+static std::string makeTransferKey(ClientId sender, const std::string& filename)
 {
     std::stringstream ss;
-    ss << senderFd << "_" << filename;
+    ss << sender << "_" << filename;
     return ss.str();
 }
 
+// A transfer that receives no FILE DATA for this long is dropped.
+static const uint64_t TRANSFER_IDLE_TIMEOUT_MS = 120 * 1000;
+
+/**
+ * @brief Timer callback: drops a transfer whose sender stopped sending data.
+ */
+static void expireTransfer(Server* server, const std::string& key)
+{
+    std::map<std::string, FileTransfer>::iterator it = server->getFileTransfers().find(key);
+    if (it == server->getFileTransfers().end())
+        return;
+    LOG_INFO("File transfer '" << it->second.getFilename() << "' from fd "
+             << ClientTable::fdOf(it->second.getSender()) << " expired");
+    server->getFileTransfers().erase(it);
+}
+
+/**
+ * @brief (Re)arms the idle expiry timer of a transfer (O(1) cancel + schedule).
+ */
+static void armTransferExpiry(Server* server, const std::string& key, FileTransfer& ft)
+{
+    server->cancelTimer(ft.getExpiryTimer());
+    ft.setExpiryTimer(server->scheduleTimer(TRANSFER_IDLE_TIMEOUT_MS,
+        [server, key]() { expireTransfer(server, key); }));
+}
+
 /**
  * @brief Handles the FILE SEND command: FILE SEND <nickname> <filename> <filesize>
  */
 static void handleFileSend(Server* server, int fd,
-    const std::vector<std::string>& tokens)
+    const IrcMessage& msg)
 {
-    if (tokens.size() < 5) {
-        std::string err = "461 FILE SEND :Not enough parameters\r\n";
-        send(fd, err.c_str(), err.size(), 0);
+    if (msg.paramCount < 4) {
+        Reply(server, fd, ERR_NEEDMOREPARAMS).param("FILE").param("SEND").send();
         return;
     }
 
-    std::string targetNick = tokens[2];
-    std::string filename = tokens[3];
-    if (!filename.empty() && filename[0] == ':')
-        filename.erase(0, 1);
-
-    std::string filesizeStr = tokens[4];
+    std::string targetNick(msg.params[1]);
+    std::string filename(msg.params[2]);
+    std::string filesizeStr(msg.params[3]);
     size_t filesize = 0;
     try {
         filesize = static_cast<size_t>(std::stoul(filesizeStr));
     } catch (...) {
-        std::string err = "461 FILE SEND :Invalid filesize\r\n";
-        send(fd, err.c_str(), err.size(), 0);
+        Reply(server, fd, ERR_NEEDMOREPARAMS).param("FILE").param("SEND").text("Invalid filesize").send();
         return;
     }
 
-    int receiverFd = -1;
-    for (std::map<int, std::unique_ptr<Client>>::iterator it = server->getClients().begin();
-        it != server->getClients().end(); ++it) {
-        if (it->second->getNickname() == targetNick) {
-            receiverFd = it->first;
-            break;
-        }
-    }
+    int receiverFd = server->findClientByNick(targetNick);
     if (receiverFd == -1) {
-        std::string err = "401 " + targetNick + " :No such nick\r\n";
-        send(fd, err.c_str(), err.size(), 0);
+        Reply(server, fd, ERR_NOSUCHNICK).param(targetNick).send();
         return;
     }
 
-    std::string key = makeTransferKey(fd, filename);
+    ClientId sender = server->getClients()[fd]->getId();
+    std::string key = makeTransferKey(sender, filename);
     if (server->getFileTransfers().count(key) != 0) {
+        server->cancelTimer(server->getFileTransfers()[key].getExpiryTimer());
         server->getFileTransfers().erase(key);
     }
 
-    FileTransfer ft(fd, receiverFd, filename, filesize);
+    FileTransfer ft(sender, server->getClients()[receiverFd]->getId(), filename, filesize);
     server->getFileTransfers().insert(std::make_pair(key, ft));
+    armTransferExpiry(server, key, server->getFileTransfers()[key]);
 
-    {
-        std::string msg = ":" + server->getServerName() + " NOTICE " + server->getClients()[fd]->getNickname() + " :Ready to receive file '" + filename + "' (" + filesizeStr + " bytes)\r\n";
-        send(fd, msg.c_str(), msg.size(), 0);
-    }
-
-    {
-        std::string msg = ":" + server->getServerName() + " NOTICE " + targetNick + " :Incoming file: " + filename + " (" + filesizeStr + " bytes).\r\n";
-        send(receiverFd, msg.c_str(), msg.size(), 0);
-    }
+    Reply(server, fd, SERVER_NOTICE).text("Ready to receive file '").text(filename)
+        .text("' (").text(filesizeStr).text(" bytes)").send();
+    Reply(server, receiverFd, SERVER_NOTICE).text("Incoming file: ").text(filename)
+        .text(" (").text(filesizeStr).text(" bytes).").send();
 }
 
 /**
  * @brief Handles the FILE DATA command: FILE DATA <filename> <base64_chunk...>
  */
 static void handleFileData(Server* server, int fd,
-    const std::vector<std::string>& tokens)
+    const IrcMessage& msg)
 {
-    if (tokens.size() < 3) {
-        std::string err = "461 FILE DATA :Not enough parameters\r\n";
-        send(fd, err.c_str(), err.size(), 0);
+    if (msg.paramCount < 2) {
+        Reply(server, fd, ERR_NEEDMOREPARAMS).param("FILE").param("DATA").send();
         return;
     }
 
-    std::string filename = tokens[2];
-    if (!filename.empty() && filename[0] == ':')
-        filename.erase(0, 1);
+    std::string filename(msg.params[1]);
 
     std::string base64chunk;
-    if (tokens.size() > 3) {
-        for (size_t i = 3; i < tokens.size(); i++) {
-            if (!base64chunk.empty())
-                base64chunk += " ";
-            std::string part = tokens[i];
-            if (!part.empty() && part[0] == ':')
-                part.erase(0, 1);
-            base64chunk += part;
-        }
+    for (size_t i = 2; i < msg.paramCount; i++) {
+        if (!base64chunk.empty())
+            base64chunk += " ";
+        base64chunk += msg.params[i];
     }
 
-    std::string key = makeTransferKey(fd, filename);
+    std::string key = makeTransferKey(server->getClients()[fd]->getId(), filename);
     if (server->getFileTransfers().count(key) == 0) {
-        std::string err = "400 :No such file transfer session\r\n";
-        send(fd, err.c_str(), err.size(), 0);
+        Reply(server, fd, ERR_UNKNOWNERROR).text("No such file transfer session").send();
         return;
     }
     FileTransfer& ft = server->getFileTransfers()[key];
 
     std::vector<char> decodedData = base64Decode(base64chunk);
     ft.appendData(decodedData);
+    armTransferExpiry(server, key, ft);
 
-    {
-        std::ostringstream oss;
-        oss << ":" << server->getServerName() << " NOTICE "
-            << server->getClients()[fd]->getNickname() << " :Uploaded "
-            << ft.getReceivedBytes() << "/" << ft.getFilesize()
-            << " bytes of [" << ft.getFilename() << "]\r\n";
-        std::string msg = oss.str();
-        send(fd, msg.c_str(), msg.size(), 0);
-    }
+    Reply(server, fd, SERVER_NOTICE).text("Uploaded ").text(ft.getReceivedBytes()).text("/")
+        .text(ft.getFilesize()).text(" bytes of [").text(ft.getFilename()).text("]").send();
 }
 
 /**
  * @brief Handles the FILE END command: FILE END <filename>
  */
 static void handleFileEnd(Server* server, int fd,
-    const std::vector<std::string>& tokens)
+    const IrcMessage& msg)
 {
-    if (tokens.size() < 3) {
-        std::string err = "461 FILE END :Not enough parameters\r\n";
-        send(fd, err.c_str(), err.size(), 0);
+    if (msg.paramCount < 2) {
+        Reply(server, fd, ERR_NEEDMOREPARAMS).param("FILE").param("END").send();
         return;
     }
 
-    std::string filename = tokens[2];
-    if (!filename.empty() && filename[0] == ':')
-        filename.erase(0, 1);
+    std::string filename(msg.params[1]);
 
-    std::string key = makeTransferKey(fd, filename);
+    std::string key = makeTransferKey(server->getClients()[fd]->getId(), filename);
     if (server->getFileTransfers().count(key) == 0) {
-        std::string err = "400 :No such file transfer session\r\n";
-        send(fd, err.c_str(), err.size(), 0);
+        Reply(server, fd, ERR_UNKNOWNERROR).text("No such file transfer session").send();
         return;
     }
 
     FileTransfer& ft = server->getFileTransfers()[key];
     bool complete = ft.isComplete();
-    int receiverFd = ft.getReceiverFd();
+    Client* receiver = server->getClients().find(ft.getReceiver());
 
     if (!complete) {
-        std::string msgSender = ":" + server->getServerName() + " NOTICE " + server->getClients()[fd]->getNickname() + " :File transfer ended, but file is incomplete (" + std::to_string(ft.getReceivedBytes()) + "/" + std::to_string(ft.getFilesize()) + ")\r\n";
-        send(fd, msgSender.c_str(), msgSender.size(), 0);
+        Reply(server, fd, SERVER_NOTICE).text("File transfer ended, but file is incomplete (")
+            .text(ft.getReceivedBytes()).text("/").text(ft.getFilesize()).text(")").send();
     } else {
-        std::string msgSender = ":" + server->getServerName() + " NOTICE " + server->getClients()[fd]->getNickname() + " :File transfer completed (" + ft.getFilename() + ")\r\n";
-        send(fd, msgSender.c_str(), msgSender.size(), 0);
+        Reply(server, fd, SERVER_NOTICE).text("File transfer completed (").text(ft.getFilename()).text(")").send();
     }
 
-    {
-        std::ostringstream oss;
-        oss << ":" << server->getServerName() << " NOTICE "
-            << server->getClients()[receiverFd]->getNickname()
-            << " :You have received file [" << ft.getFilename()
-            << "] with size " << ft.getFileBuffer().size() << " bytes\r\n";
-        std::string infoMsg = oss.str();
-        send(receiverFd, infoMsg.c_str(), infoMsg.size(), 0);
-    }
+    if (!receiver) {
+        Reply(server, fd, SERVER_NOTICE).text("The receiver of ").text(ft.getFilename())
+            .text(" has left, file not delivered").send();
+    } else {
+        Reply(server, receiver->getFd(), SERVER_NOTICE).text("You have received file [")
+            .text(ft.getFilename()).text("] with size ").text(ft.getFileBuffer().size()).text(" bytes").send();
 
-    {
         const std::vector<char>& fileBuf = ft.getFileBuffer();
         if (!fileBuf.empty()) {
-            send(receiverFd, &fileBuf[0], fileBuf.size(), 0);
+            server->safeSend(receiver->getFd(), std::string(fileBuf.begin(), fileBuf.end()));
         }
     }
 
+    server->cancelTimer(ft.getExpiryTimer());
     server->getFileTransfers().erase(key);
 }
 
 /**
  * @brief Main handler for the FILE command.
  */
-void handleFileCommand(Server* server, int fd,
-    const std::vector<std::string>& tokens,
-    const std::string& /*fullCommand*/)
+void handleFileCommand(Server* server, int fd, const IrcMessage& msg)
 {
-    if (tokens.size() < 2) {
-        std::string err = "461 FILE :Not enough parameters\r\n";
-        send(fd, err.c_str(), err.size(), 0);
-        return;
-    }
-
-    std::string subcmd = tokens[1];
+    std::string subcmd(msg.params[0]);
     std::transform(subcmd.begin(), subcmd.end(), subcmd.begin(), ::toupper);
 
     if (subcmd == "SEND") {
-        handleFileSend(server, fd, tokens);
+        handleFileSend(server, fd, msg);
     } else if (subcmd == "DATA") {
-        handleFileData(server, fd, tokens);
+        handleFileData(server, fd, msg);
     } else if (subcmd == "END") {
-        handleFileEnd(server, fd, tokens);
+        handleFileEnd(server, fd, msg);
     } else {
-        std::string err = "400 :Unknown FILE subcommand\r\n";
-        send(fd, err.c_str(), err.size(), 0);
+        Reply(server, fd, ERR_UNKNOWNERROR).text("Unknown FILE subcommand").send();
     }
 }
 
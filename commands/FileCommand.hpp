@@ -1,8 +1,7 @@
 #ifndef FILECOMMAND_HPP
 #define FILECOMMAND_HPP
 
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 #include "../include/Server.hpp"
 
@@ -14,8 +13,6 @@
  *   FILE DATA <filename> <base64_chunk>
  *   FILE END  <filename>
  */
-void handleFileCommand(Server* server, int fd,
-                       const std::vector<std::string>& tokens,
-                       const std::string&              fullCommand);
+void handleFileCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif  // FILECOMMAND_HPP
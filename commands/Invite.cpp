@@ -5,6 +5,7 @@
 #include <string>
 
 #include "../include/Channel.hpp"
+#include "../include/Replies.hpp"
 #include "../include/Server.hpp"
 
 /**
@@ -17,15 +18,7 @@ std::pair<int, Channel*> findUserAndChannel(Server*            server,
                                             const std::string& targetNick,
                                             const std::string& channelName)
 {
-    int targetFd = -1;
-    for (const auto& pair : server->getClients())
-    {
-        if (pair.second->getNickname() == targetNick)
-        {
-            targetFd = pair.first;
-            break;
-        }
-    }
+    int targetFd = server->findClientByNick(targetNick);
 
     auto     it = server->getChannels().find(channelName);
     Channel* channel =
@@ -38,21 +31,18 @@ std::pair<int, Channel*> findUserAndChannel(Server*            server,
  * @brief Checks if a user (fd) can invite others to a channel.
  * If not, sends the appropriate error message.
  */
-bool canUserInvite(int fd, Channel* channel, const std::string& channelName)
+bool canUserInvite(Server* server, int fd, Channel* channel, const std::string& channelName)
 {
-    if (!channel->hasClient(fd))
+    ClientId id = server->getClients()[fd]->getId();
+    if (!channel->hasClient(id))
     {
-        std::string reply =
-            "442 " + channelName + " :You're not on that channel\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+        Reply(server, fd, ERR_NOTONCHANNEL).param(channelName).send();
         return false;
     }
 
-    if (!channel->isOperator(fd))
+    if (!channel->isOperator(id))
     {
-        std::string reply =
-            "482 " + channelName + " :You're not a channel operator\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+        Reply(server, fd, ERR_CHANOPRIVSNEEDED).param(channelName).text("You're not a channel operator").send();
         return false;
     }
 
@@ -70,16 +60,14 @@ void processInvite(Server* server, int fd, int targetFd, Channel* channel,
                    const std::string& targetNick,
                    const std::string& channelName)
 {
-    if (channel->hasClient(targetFd))
+    if (channel->hasClient(server->getClients()[targetFd]->getId()))
     {
-        std::string reply = "443 " + targetNick + " " + channelName +
-                            " :is already on channel\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+        Reply(server, fd, ERR_USERONCHANNEL).param(targetNick).param(channelName).send();
         return;
     }
-    channel->inviteClient(targetFd);
+    server->inviteToChannel(targetFd, *channel);
 
-    Client*     inviter = server->getClients()[fd].get();
+    Client*     inviter = server->getClients()[fd];
     std::string nick    = inviter->getNickname();
     std::string user    = inviter->getUsername();
     if (user.empty())
@@ -95,44 +83,24 @@ void processInvite(Server* server, int fd, int targetFd, Channel* channel,
 
     std::string inviteMsg =
         prefix + " INVITE " + targetNick + " " + channelName + "\r\n";
-    send(targetFd, inviteMsg.c_str(), inviteMsg.size(), 0);
+    server->safeSend(targetFd, inviteMsg);
 
-    std::string confirmMsg =
-        "341 " + nick + " " + targetNick + " " + channelName + "\r\n";
-    send(fd, confirmMsg.c_str(), confirmMsg.size(), 0);
+    Reply(server, fd, RPL_INVITING).param(targetNick).param(channelName).send();
 }
 
 /**
  * @brief Handles the INVITE command.
- * Steps performed:
- *  1. Checks if the client is registered (otherwise 451).
- *  2. Checks if the required parameters are provided (otherwise 461).
+ * Steps performed (registration and parameters are checked by the dispatcher):
  *  3. Searches for the channel and target user (errors 403 and 401).
  *  4. Verifies if the inviter has the necessary rights (errors 442/482).
  *  5. If the target user is already in the channel (including self-invite) —
  * error 443.
  *  6. Otherwise, processes the invite.
  */
-void handleInviteCommand(Server* server, int fd,
-                         const std::vector<std::string>& tokens,
-                         const std::string& /*command*/)
+void handleInviteCommand(Server* server, int fd, const IrcMessage& msg)
 {
-    if (server->getClients()[fd]->authState != AUTH_REGISTERED)
-    {
-        std::string err = "451 :You have not registered\r\n";
-        send(fd, err.c_str(), err.size(), 0);
-        return;
-    }
-
-    if (tokens.size() < 3)
-    {
-        std::string err = "461 INVITE :Not enough parameters\r\n";
-        send(fd, err.c_str(), err.size(), 0);
-        return;
-    }
-
-    std::string targetNick  = tokens[1];
-    std::string channelName = tokens[2];
+    std::string targetNick(msg.params[0]);
+    std::string channelName(msg.params[1]);
 
     auto [targetFd, channel] =
         findUserAndChannel(server, targetNick, channelName);
@@ -140,19 +108,17 @@ void handleInviteCommand(Server* server, int fd,
     bool hasErrors = false;
     if (!channel)
     {
-        std::string reply = "403 " + channelName + " :No such channel\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+        Reply(server, fd, ERR_NOSUCHCHANNEL).param(channelName).send();
         hasErrors = true;
     }
     if (targetFd == -1)
     {
-        std::string reply = "401 " + targetNick + " :No such nick/channel\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+        Reply(server, fd, ERR_NOSUCHNICK).param(targetNick).send();
         hasErrors = true;
     }
     if (hasErrors) return;
 
-    if (!canUserInvite(fd, channel, channelName)) return;
+    if (!canUserInvite(server, fd, channel, channelName)) return;
 
     processInvite(server, fd, targetFd, channel, targetNick, channelName);
 }
\ No newline at end of file
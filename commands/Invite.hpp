@@ -1,8 +1,7 @@
 #ifndef INVITE_HPP
 #define INVITE_HPP
 
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 /**
  * @brief Forward declaration of the Server class.
@@ -19,9 +18,8 @@ class Server;
  *
  * @param server Pointer to the Server object managing the IRC server.
  * @param fd The file descriptor of the client that sent the INVITE command.
- * @param tokens The tokenized command arguments (expected: INVITE <targetNick> <channel>).
- * @param command The complete command string.
+ * @param msg The parsed command (expected: INVITE <targetNick> <channel>).
  */
-void handleInviteCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handleInviteCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // INVITE_HPP
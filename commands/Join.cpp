@@ -1,31 +1,13 @@
 #include "Join.hpp"
 #include "../include/Channel.hpp"
 #include "../include/Client.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Replies.hpp"
 #include "../include/Server.hpp"
-#include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
 
-/**
- * @brief Sends a properly formatted numeric reply to the client.
- *
- * The reply follows the IRC format:
- *   :<server> <numeric> <nick> <args> :<message>
- *
- * @param server Pointer to the Server.
- * @param fd The client's file descriptor.
- * @param numeric The numeric code (e.g. "473").
- * @param args Additional arguments (usually the channel name).
- * @param message The message text.
- */
-static void sendNumericWithServer(Server* server, int fd, const std::string& numeric,
-    const std::string& args, const std::string& message)
-{
-    std::string reply = ":" + server->getServerName() + " " + numeric + " " + server->getClients()[fd]->getNickname() + " " + args + " :" + message + "\r\n";
-    send(fd, reply.c_str(), reply.size(), 0);
-}
-
 /**
  * @brief Validates the channel name.
  *
@@ -39,8 +21,7 @@ static void sendNumericWithServer(Server* server, int fd, const std::string& num
 static bool validateChannelName(Server* server, int fd, const std::string& channelName)
 {
     if (channelName.empty() || channelName[0] != '#') {
-        sendNumericWithServer(server, fd, "479", channelName,
-            "Illegal channel name. Channel names must start with '#'");
+        Reply(server, fd, ERR_BADCHANNAME).param(channelName).send();
         return false;
     }
     return true;
@@ -60,48 +41,13 @@ static bool validateChannelName(Server* server, int fd, const std::string& chann
 static void broadcastJoin(Server* server, const std::string& channelName,
     const std::string& prefix, int joiningFd)
 {
-    std::string joinMsg = prefix + " JOIN " + channelName + "\r\n";
+    SharedMessage joinMsg = std::make_shared<const std::string>(prefix + " JOIN " + channelName + "\r\n");
     // Send JOIN event to the joining client.
-    send(joiningFd, joinMsg.c_str(), joinMsg.size(), 0);
-    // Send JOIN event to all other members in the channel.
-    Channel& chan = server->getChannels()[channelName];
-    for (int clientFd : chan.getClients()) {
-        if (clientFd != joiningFd) {
-            send(clientFd, joinMsg.c_str(), joinMsg.size(), 0);
-        }
-    }
-}
-
-/**
- * @brief Sends the NAMES list replies (353 and 366) to the client.
- *
- * This informs the client of the list of users in the channel.
- *
- * @param server Pointer to the Server.
- * @param fd The client's file descriptor.
- * @param channelName The channel name.
- */
-static void sendNamesReply(Server* server, int fd, const std::string& channelName)
-{
-    Channel& chan = server->getChannels()[channelName];
-    std::string nick = server->getClients()[fd]->getNickname();
-
-    // Build the 353 reply (names list).
-    std::string names = "353 " + nick + " = " + channelName + " :";
-    for (int cli_fd : chan.getClients()) {
-        if (chan.isOperator(cli_fd)) {
-            names += "@";
-        }
-        names += server->getClients()[cli_fd]->getNickname() + " ";
-    }
-    names += "\r\n";
-    // Prepend the server prefix.
-    std::string fullNames = ":" + server->getServerName() + " " + names;
-    send(fd, fullNames.c_str(), fullNames.size(), 0);
-
-    std::string endNames = "366 " + nick + " " + channelName + " :End of /NAMES list\r\n";
-    std::string fullEndNames = ":" + server->getServerName() + " " + endNames;
-    send(fd, fullEndNames.c_str(), fullEndNames.size(), 0);
+    server->safeSend(joiningFd, joinMsg);
+    // Send JOIN event to all other members in the channel (members owned by
+    // other event-loop threads receive it through their mailbox).
+    server->sendToChannel(server->getChannels()[channelName], joinMsg,
+        server->getClients()[joiningFd]->getId());
 }
 
 /**
@@ -115,17 +61,15 @@ static void sendTopicReply(Server* server, int fd, const std::string& channelNam
 {
     Channel& chan = server->getChannels()[channelName];
     if (!chan.getTopic().empty()) {
-        std::string topicMsg = "332 " + server->getClients()[fd]->getNickname() + " " + channelName + " :" + chan.getTopic() + "\r\n";
-        std::string fullTopic = ":" + server->getServerName() + " " + topicMsg;
-        send(fd, fullTopic.c_str(), fullTopic.size(), 0);
+        Reply(server, fd, RPL_TOPIC).param(channelName).text(chan.getTopic()).send();
     }
 }
 
 /**
  * @brief Handles the JOIN command from a client.
  *
- * Processes the JOIN command. Checks that the client is registered, validates
- * the channel name, and then:
+ * Processes the JOIN command (the dispatcher has checked registration and
+ * parameters). Validates the channel name, and then:
  * - If the channel exists and has invite-only mode (+i) enabled, verifies that the
  *   client is either an operator or invited. If not, sends error 473.
  * - If the channel does not exist, creates it (standard IRC behavior).
@@ -135,34 +79,20 @@ static void sendTopicReply(Server* server, int fd, const std::string& channelNam
  *
  * @param server Pointer to the Server.
  * @param fd The client's file descriptor.
- * @param tokens The tokenized JOIN command (expected tokens: "JOIN", channel, [key]).
- * @param command The full JOIN command string.
+ * @param msg The parsed JOIN command (expected parameters: channel, [key]).
  */
-void handleJoinCommand(Server* server, int fd,
-    const std::vector<std::string>& tokens,
-    const std::string& command)
+void handleJoinCommand(Server* server, int fd, const IrcMessage& msg)
 {
-    (void)command; // Unused
-
-    if (server->getClients()[fd]->authState != AUTH_REGISTERED) {
-        sendNumericWithServer(server, fd, "451", "", "You have not registered");
-        return;
-    }
-
-    if (tokens.size() < 2) {
-        sendNumericWithServer(server, fd, "461", "JOIN", "Not enough parameters");
-        return;
-    }
-
-    std::string channelName = tokens[1];
+    std::string channelName(msg.params[0]);
     if (!validateChannelName(server, fd, channelName))
         return;
 
     auto& channels = server->getChannels();
     auto it = channels.find(channelName);
+    ClientId id = server->getClients()[fd]->getId();
 
-    if (it != channels.end() && it->second.hasClient(fd)) {
-        sendNumericWithServer(server, fd, "443", channelName, "You are already in the channel");
+    if (it != channels.end() && it->second.hasClient(id)) {
+        Reply(server, fd, ERR_USERONCHANNEL).param(channelName).text("You are already in the channel").send();
         return;
     }
 
@@ -170,7 +100,7 @@ void handleJoinCommand(Server* server, int fd,
     if (it == channels.end()) {
         auto result = channels.emplace(channelName, Channel(channelName));
         if (!result.second) {
-            std::cerr << "Failed to create channel: " << channelName << std::endl;
+            LOG_ERROR("Failed to create channel: " << channelName);
             return;
         }
         it = result.first;
@@ -180,38 +110,36 @@ void handleJoinCommand(Server* server, int fd,
     Channel& chan = it->second;
 
     // --- Invite-only check (+i) ---
-    if (chan.isInviteOnly() && !chan.isOperator(fd) && !chan.isInvited(fd)) {
-        sendNumericWithServer(server, fd, "473", channelName, "Cannot join channel (+i mode set)");
+    if (chan.isInviteOnly() && !chan.isOperator(id) && !chan.isInvited(id)) {
+        Reply(server, fd, ERR_INVITEONLYCHAN).param(channelName).send();
         return;
     }
 
     // --- User limit check (+l) ---
     if (chan.getUserLimit() > 0 && static_cast<int>(chan.getClients().size()) >= chan.getUserLimit()) {
-        sendNumericWithServer(server, fd, "471", channelName, "Channel is full");
+        Reply(server, fd, ERR_CHANNELISFULL).param(channelName).send();
         return;
     }
 
     // --- Channel key check (+k) ---
     if (chan.hasMode('k')) {
-        if (tokens.size() < 3 || chan.getChannelKey() != tokens[2]) {
-            sendNumericWithServer(server, fd, "475", channelName, "Cannot join channel (+k mode set)");
+        if (msg.paramCount < 2 || chan.getChannelKey() != msg.params[1]) {
+            Reply(server, fd, ERR_BADCHANNELKEY).param(channelName).send();
             return;
         }
     }
 
-    chan.addClient(fd);
-    if (chan.isInvited(fd)) {
-        chan.removeInvite(fd);
-    }
+    server->joinChannel(fd, chan);
 
     if (isFirstUser) {
-        chan.addOperator(fd);
-        std::string opMsg = server->getClients()[fd]->getNickname() + " MODE " + channelName + " +o " + server->getClients()[fd]->getNickname();
-        sendNumericWithServer(server, fd, "MODE", channelName, opMsg);
+        chan.addOperator(id);
+        const std::string& nick = server->getClients()[fd]->getNickname();
+        Reply(server, fd, SERVER_MODE).param(channelName)
+            .text(nick).text(" MODE ").text(channelName).text(" +o ").text(nick).send();
     }
 
     // Build the prefix string in the format: ":Nick!user@host"
-    Client* client = server->getClients()[fd].get();
+    Client* client = server->getClients()[fd];
     std::string nick = client->getNickname();
     std::string user = client->getUsername();
     if (user.empty()) {
@@ -221,6 +149,6 @@ void handleJoinCommand(Server* server, int fd,
     std::string prefix = ":" + nick + "!" + user + "@" + host;
 
     broadcastJoin(server, channelName, prefix, fd);
-    sendNamesReply(server, fd, channelName);
+    sendNames(server, fd, chan);
     sendTopicReply(server, fd, channelName);
 }
@@ -1,7 +1,6 @@
 #ifndef JOIN_HPP
 #define JOIN_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 /**
  * @brief Forward declaration of the Server class.
@@ -20,12 +19,8 @@ class Server;
  *
  * @param server Pointer to the Server object managing the IRC server.
  * @param fd The file descriptor of the client issuing the JOIN command.
- * @param tokens A vector containing the tokenized command arguments (expected:
- * "JOIN" and <channelName>).
- * @param command The complete command string received from the client.
+ * @param msg The parsed command (expected: JOIN <channelName> [<key>]).
  */
-void handleJoinCommand(Server* server, int fd,
-                       const std::vector<std::string>& tokens,
-                       const std::string&              command);
+void handleJoinCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif  // JOIN_HPP
@@ -1,7 +1,6 @@
 #ifndef KICK_HPP
 #define KICK_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 /**
  * @brief Forward declaration of the Server class.
@@ -20,12 +19,9 @@ class Server;
  *
  * @param server Pointer to the Server object managing the IRC server.
  * @param fd The file descriptor of the client issuing the KICK command.
- * @param tokens A vector of strings containing the tokenized command arguments
- * (expected format: "KICK", <channelName>, <targetNick>).
- * @param command The complete command string.
+ * @param msg The parsed command (expected format: KICK <channelName>
+ * <targetNick> [:<comment>]).
  */
-void handleKickCommand(Server* server, int fd,
-                       const std::vector<std::string>& tokens,
-                       const std::string&              command);
+void handleKickCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif  // KICK_HPP
@@ -1,54 +1,51 @@
 #include "List.hpp"
 #include "../include/Server.hpp"
 #include "../include/Channel.hpp"
-#include <sstream>
+#include "../include/ListQuery.hpp"
+#include "../include/Replies.hpp"
 #include <string>
-#include <sys/socket.h>
 
 /**
  * @brief Handles the LIST command from a client.
  *
- * The LIST command shows all existing channels on the server,
+ * The LIST command shows the existing channels on the server,
  * including the number of users in each and the channel's topic (if any).
  * 
  * According to IRC protocol:
  *  - "322" is RPL_LIST: <channel> <#visible> :<topic>
  *  - "323" is RPL_LISTEND: signals the end of the list.
  *
+ * The optional first parameter filters the channels (see `ListQuery`):
+ * `LIST >50,#rust*,!#rust-offtopic,T:*release*`. A list of plain channel
+ * names is answered at once, by lookup; anything else walks every channel
+ * and is streamed over several loop passes by `Server::startList()`.
+ *
  * @param server   Pointer to the Server instance.
  * @param fd       File descriptor of the requesting client.
- * @param tokens   Tokenized command arguments (unused here).
- * @param command  The raw command string (unused here).
+ * @param msg      The parsed command: LIST [<filter>{,<filter>}].
  */
-void handleListCommand(Server* server, int fd,
-                       const std::vector<std::string>& tokens,
-                       const std::string& command)
+void handleListCommand(Server* server, int fd, const IrcMessage& msg)
 {
-    // We don't need 'tokens' or 'command' here, but we keep them to match signature.
-    (void)tokens;
-    (void)command;
+    ListQuery query(msg.param(0));
+
+    if (!query.isExact()) {
+        server->startList(fd, query);
+        return;
+    }
 
-    // For each channel on the server, we build a "322" response.
-    //  "322 <nick> <channelName> <clientCount> :<topic>"
-    // Then we send a final "323 <nick> :End of LIST" to mark completion.
-    std::string reply;
-    for (auto& pair : server->getChannels())
+    // Named channels: one "322" per channel that exists (and passes the other filters),
+    //  ":<server> 322 <nick> <channelName> <clientCount> :<topic>"
+    // then "323", which is RPL_LISTEND: signals no more channels to list.
+    const std::vector<std::string>& names = query.getNames();
+    for (size_t i = 0; i < names.size(); ++i)
     {
-        Channel& channel = pair.second;
+        std::map<std::string, Channel>::iterator it = server->getChannels().find(names[i]);
+        if (it == server->getChannels().end() || !query.matches(it->second))
+            continue;
 
-        // Gather all the info in an IRC-compliant line.
-        // <clientCount> is channel.getClients().size(), i.e. number of users in the channel.
-        std::ostringstream oss;
-        oss << "322 " << server->getClients()[fd]->getNickname() << " "
-            << channel.getName() << " " << channel.getClients().size()
-            << " :" << channel.getTopic() << "\r\n";
-        
-        // Convert stream to string and send to the requesting client.
-        reply = oss.str();
-        send(fd, reply.c_str(), reply.size(), 0);
+        Channel& channel = it->second;
+        Reply(server, fd, RPL_LIST).param(channel.getName())
+            .param(channel.getClients().size()).text(channel.getTopic()).send();
     }
-
-    // Finally, send "323", which is RPL_LISTEND: signals no more channels to list.
-    reply = "323 " + server->getClients()[fd]->getNickname() + " :End of LIST\r\n";
-    send(fd, reply.c_str(), reply.size(), 0);
+    Reply(server, fd, RPL_LISTEND).send();
 }
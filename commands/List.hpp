@@ -1,20 +1,19 @@
 #ifndef LIST_HPP
 #define LIST_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 class Server;
 
 /**
  * @brief Handles the LIST command.
  *
- * Lists all channels along with the number of users and the topic.
+ * Lists the channels matching the optional filters, with the number of users
+ * and the topic of each.
  *
  * @param server Pointer to the Server object.
  * @param fd File descriptor of the requesting client.
- * @param tokens Tokenized command arguments (необязательно используются).
- * @param command The complete command string.
+ * @param msg The parsed command: LIST [<filter>{,<filter>}] (see `ListQuery`).
  */
-void handleListCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handleListCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // LIST_HPP
@@ -1,4 +1,6 @@
 #include "../include/Channel.hpp"
+#include "../include/IrcMessage.hpp"
+#include "../include/Replies.hpp"
 #include "../include/Server.hpp"
 #include <cctype>
 #include <map>
@@ -6,7 +8,6 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
-#include <sys/socket.h>
 #include <vector>
 
 /**
@@ -18,36 +19,6 @@ struct ModeChange {
     std::string param; 
 };
 
-/**
- * @brief Sends a reply message to a client.
- *
- * @param fd Client's file descriptor.
- * @param message The message to send.
- */
-static void sendReply(int fd, const std::string& message)
-{
-    send(fd, message.c_str(), message.size(), 0);
-}
-
-/**
- * @brief Checks if the client is registered.
- *
- * If not, sends the appropriate error message.
- *
- * @param server Pointer to the server.
- * @param fd Client's file descriptor.
- * @return true if registered, false otherwise.
- */
-static bool checkRegistration(Server* server, int fd)
-{
-    // Using operator-> of unique_ptr works as usual.
-    if (server->getClients()[fd]->authState != AUTH_REGISTERED) {
-        sendReply(fd, "451 :You have not registered\r\n");
-        return false;
-    }
-    return true;
-}
-
 /**
  * @brief Retrieves a pointer to the channel by name.
  *
@@ -64,7 +35,7 @@ static Channel* getChannel(Server* server, int fd,
     std::map<std::string, Channel>& channels = server->getChannels();
     std::map<std::string, Channel>::iterator it = channels.find(channelName);
     if (it == channels.end()) {
-        sendReply(fd, "403 " + channelName + " :No such channel\r\n");
+        Reply(server, fd, ERR_NOSUCHCHANNEL).param(channelName).send();
         return NULL;
     }
     return &(it->second);
@@ -97,16 +68,13 @@ static void printCurrentModes(Server* server, int fd, Channel& channel,
     else
         modes = "+" + modes;
 
-    std::ostringstream reply;
-    reply << "324 " << server->getClients()[fd]->getNickname() << " "
-          << channelName << " " << modes;
-
+    Reply reply(server, fd, RPL_CHANNELMODEIS);
+    reply.param(channelName).param(modes);
     if (channel.hasMode('k'))
-        reply << " " << channel.getChannelKey();
+        reply.param(channel.getChannelKey());
     if (channel.hasMode('l'))
-        reply << " " << std::to_string(channel.getUserLimit());
-    reply << "\r\n";
-    sendReply(fd, reply.str());
+        reply.param(channel.getUserLimit());
+    reply.send();
 }
 
 /**
@@ -119,19 +87,19 @@ static void printCurrentModes(Server* server, int fd, Channel& channel,
  * @param fd Client's file descriptor.
  * @param channel Reference to the channel.
  * @param modeStr The mode string (e.g. "+ikl-t").
- * @param tokens The vector of command tokens.
- * @param paramIdx Index in tokens where parameters start.
+ * @param msg The parsed MODE command.
+ * @param paramIdx Index in `msg.params` of the next mode parameter.
  * @param changes Vector to store applied mode changes.
  * @return true if parsing and application succeeded, false otherwise.
  */
 static bool parseAndApplyModeChanges(Server* server, int fd, Channel& channel,
     const std::string& modeStr,
-    const std::vector<std::string>& tokens,
+    const IrcMessage& msg,
     size_t& paramIdx,
     std::vector<ModeChange>& changes)
 {
     if (modeStr.empty() || (modeStr[0] != '+' && modeStr[0] != '-')) {
-        sendReply(fd, "472 " + server->getClients()[fd]->getNickname() + " :Invalid mode string\r\n");
+        Reply(server, fd, ERR_UNKNOWNMODE).text("Invalid mode string").send();
         return false;
     }
 
@@ -161,12 +129,11 @@ static bool parseAndApplyModeChanges(Server* server, int fd, Channel& channel,
         }
         case 'k': {
             if (currentSign) {
-                if (paramIdx >= tokens.size()) {
-                    sendReply(fd,
-                        "461 MODE :Not enough parameters for +k\r\n");
+                if (paramIdx >= msg.paramCount) {
+                    Reply(server, fd, ERR_NEEDMOREPARAMS).param("MODE").text("Not enough parameters for +k").send();
                     return false;
                 }
-                std::string key = tokens[paramIdx++];
+                std::string key(msg.params[paramIdx++]);
                 channel.setMode('k', true, key);
                 change.param = key;
                 changes.push_back(change);
@@ -178,25 +145,22 @@ static bool parseAndApplyModeChanges(Server* server, int fd, Channel& channel,
         }
         case 'l': {
             if (currentSign) {
-                if (paramIdx >= tokens.size()) {
-                    sendReply(fd,
-                        "461 MODE :Not enough parameters for +l\r\n");
+                if (paramIdx >= msg.paramCount) {
+                    Reply(server, fd, ERR_NEEDMOREPARAMS).param("MODE").text("Not enough parameters for +l").send();
                     return false;
                 }
-                std::string limitStr = tokens[paramIdx++];
+                std::string limitStr(msg.params[paramIdx++]);
                 try {
                     int limit = std::stoi(limitStr);
                     if (limit <= 0) {
-                        sendReply(
-                            fd, "461 MODE l :Invalid limit parameter\r\n");
+                        Reply(server, fd, ERR_NEEDMOREPARAMS).param("MODE").param("l").text("Invalid limit parameter").send();
                         return false;
                     }
                     channel.setMode('l', true, limitStr);
                     change.param = limitStr;
                     changes.push_back(change);
                 } catch (const std::exception&) {
-                    sendReply(fd,
-                        "461 MODE l :Invalid limit parameter\r\n");
+                    Reply(server, fd, ERR_NEEDMOREPARAMS).param("MODE").param("l").text("Invalid limit parameter").send();
                     return false;
                 }
             } else {
@@ -206,48 +170,30 @@ static bool parseAndApplyModeChanges(Server* server, int fd, Channel& channel,
             break;
         }
         case 'o': {
-            if (paramIdx >= tokens.size()) {
-                sendReply(fd,
-                    "461 MODE :Not enough parameters for +o/-o\r\n");
+            if (paramIdx >= msg.paramCount) {
+                Reply(server, fd, ERR_NEEDMOREPARAMS).param("MODE").text("Not enough parameters for +o/-o").send();
                 return false;
             }
-            std::string targetNick = tokens[paramIdx++];
-            int targetFd = -1;
-            // Note: getClients() returns a map<int,
-            // std::unique_ptr<Client>>
-            std::map<int, std::unique_ptr<Client>>& clients = server->getClients();
-            for (std::map<int, std::unique_ptr<Client>>::iterator it = clients.begin();
-                it != clients.end(); ++it) {
-                if (it->second->getNickname() == targetNick) {
-                    targetFd = it->first;
-                    break;
-                }
-            }
+            std::string targetNick(msg.params[paramIdx++]);
+            int targetFd = server->findClientByNick(targetNick);
             if (targetFd == -1) {
-                sendReply(fd, "401 " + targetNick + " :No such nick\r\n");
+                Reply(server, fd, ERR_NOSUCHNICK).param(targetNick).send();
                 return false;
             }
-            if (!channel.hasClient(targetFd)) {
-                sendReply(fd, "441 " + targetNick + " " + channel.getName() + " :They aren't on that channel\r\n");
+            ClientId targetId = server->getClients()[targetFd]->getId();
+            if (!channel.hasClient(targetId)) {
+                Reply(server, fd, ERR_USERNOTINCHANNEL).param(targetNick).param(channel.getName()).send();
                 return false;
             }
             if (currentSign) {
-                channel.addOperator(targetFd);
+                channel.addOperator(targetId);
             } else {
-                if (channel.isOperator(targetFd)) {
-                    int opCount = 0;
-                    std::vector<int> channelClients = channel.getClients();
-                    for (std::vector<int>::iterator it = channelClients.begin();
-                        it != channelClients.end(); ++it) {
-                        if (channel.isOperator(*it))
-                            ++opCount;
-                    }
-                    if (opCount > 1) {
-                        channel.removeOperator(targetFd);
+                if (channel.isOperator(targetId)) {
+                    if (channel.getOperatorCount() > 1) {
+                        channel.removeOperator(targetId);
                     } else {
-                        sendReply(
-                            fd,
-                            "482 " + channel.getName() + " :Cannot remove the last operator\r\n");
+                        Reply(server, fd, ERR_CHANOPRIVSNEEDED).param(channel.getName())
+                            .text("Cannot remove the last operator").send();
                         return false;
                     }
                 }
@@ -257,7 +203,7 @@ static bool parseAndApplyModeChanges(Server* server, int fd, Channel& channel,
             break;
         }
         default: {
-            sendReply(fd, "472 " + server->getClients()[fd]->getNickname() + " " + std::string(1, c) + " :is unknown mode char to me\r\n");
+            Reply(server, fd, ERR_UNKNOWNMODE).param(std::string_view(&modeStr[i], 1)).send();
             break;
         }
         }
@@ -294,10 +240,8 @@ static void broadcastModeChange(Server* server, int sourceFd, Channel& channel,
             nonOpChanges.push_back(changes[i]);
     }
 
-    auto sendToChannel = [&](const std::string& msg) {
-        std::vector<int> clients = channel.getClients();
-        for (size_t i = 0; i < clients.size(); ++i)
-            sendReply(clients[i], msg);
+    auto sendToChannel = [&](const SharedMessage& msg) {
+        server->sendToChannel(channel, msg);
     };
 
     if (!nonOpChanges.empty()) {
@@ -315,7 +259,7 @@ static void broadcastModeChange(Server* server, int sourceFd, Channel& channel,
                 modeParams.push_back(nonOpChanges[i].param);
         }
 
-        Client* sourceClient = server->getClients()[sourceFd].get();
+        Client* sourceClient = server->getClients()[sourceFd];
         std::string nick = sourceClient->getNickname();
         std::string user = sourceClient->getUsername();
         std::string host = sourceClient->getHost();
@@ -331,11 +275,11 @@ static void broadcastModeChange(Server* server, int sourceFd, Channel& channel,
         for (size_t i = 0; i < modeParams.size(); ++i)
             broadcast << " " << modeParams[i];
         broadcast << "\r\n";
-        sendToChannel(broadcast.str());
+        sendToChannel(std::make_shared<const std::string>(broadcast.str()));
     }
 
     for (size_t i = 0; i < opChanges.size(); ++i) {
-        Client* sourceClient = server->getClients()[sourceFd].get();
+        Client* sourceClient = server->getClients()[sourceFd];
         std::string nick = sourceClient->getNickname();
         std::string user = sourceClient->getUsername();
         std::string host = sourceClient->getHost();
@@ -349,46 +293,32 @@ static void broadcastModeChange(Server* server, int sourceFd, Channel& channel,
         broadcast << prefix << " MODE " << channel.getName() << " "
                   << (opChanges[i].add ? "+o" : "-o") << " "
                   << opChanges[i].param << "\r\n";
-        sendToChannel(broadcast.str());
+        sendToChannel(std::make_shared<const std::string>(broadcast.str()));
     }
 }
 
 /**
  * @brief Handles the MODE command.
  *
- * Validates the command, checks registration, retrieves the channel, and either
+ * Retrieves the channel (the dispatcher has checked registration and
+ * parameters), and either
  * prints the current modes or parses and applies new mode changes. Finally,
  * broadcasts the changes.
  *
  * @param server Pointer to the server.
  * @param fd Client's file descriptor.
- * @param tokens Parsed command tokens.
- * @param rawCommand The raw command string.
+ * @param msg The parsed command.
  */
-void handleModeCommand(Server* server, int fd,
-    const std::vector<std::string>& tokens,
-    const std::string& rawCommand)
+void handleModeCommand(Server* server, int fd, const IrcMessage& msg)
 {
-    (void)rawCommand;
-
-    if (!checkRegistration(server, fd))
-        return;
-
-    if (tokens.size() < 2) {
-        sendReply(fd, "461 MODE :Not enough parameters\r\n");
-        return;
-    }
-
-    std::string channelName = tokens[1];
+    std::string channelName(msg.params[0]);
 
     if (!channelName.empty() && channelName[0] != '#') {
-        std::string myNick = server->getClients()[fd]->getNickname();
-        if (channelName != myNick) {
-            sendReply(fd, "502 " + channelName + " :Cannot change mode for other users\r\n");
+        if (channelName != server->getClients()[fd]->getNickname()) {
+            Reply(server, fd, ERR_USERSDONTMATCH).send();
             return;
         }
-        std::string notice = "NOTICE " + myNick + " :User modes not used on this server\r\n";
-        sendReply(fd, notice);
+        Reply(server, fd, SERVER_NOTICE).text("User modes not used on this server").send();
 
         return;
     }
@@ -397,22 +327,21 @@ void handleModeCommand(Server* server, int fd,
     if (!channel)
         return;
 
-    if (tokens.size() == 2) {
+    if (msg.paramCount == 1) {
         printCurrentModes(server, fd, *channel, channelName);
         return;
     }
 
-    if (!channel->isOperator(fd)) {
-        sendReply(fd,
-            "482 " + channelName + " :You're not a channel operator\r\n");
+    if (!channel->isOperator(server->getClients()[fd]->getId())) {
+        Reply(server, fd, ERR_CHANOPRIVSNEEDED).param(channelName).text("You're not a channel operator").send();
         return;
     }
 
-    std::string modeStr = tokens[2];
-    size_t paramIdx = 3;
+    std::string modeStr(msg.params[1]);
+    size_t paramIdx = 2;
     std::vector<ModeChange> changes;
 
-    if (!parseAndApplyModeChanges(server, fd, *channel, modeStr, tokens,
+    if (!parseAndApplyModeChanges(server, fd, *channel, modeStr, msg,
             paramIdx, changes))
         return;
     broadcastModeChange(server, fd, *channel, changes);
@@ -1,7 +1,6 @@
 #ifndef MODE_HPP
 #define MODE_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 /**
  * @brief Forward declaration of the Server class.
@@ -19,9 +18,8 @@ class Server;
  *
  * @param server Pointer to the Server object managing the IRC server.
  * @param fd The file descriptor of the client issuing the MODE command.
- * @param tokens A vector of strings representing the tokenized command (e.g., ["MODE", "<channel>", "<mode>", "[<param>]"]).
- * @param command The complete command string received from the client.
+ * @param msg The parsed command (e.g., MODE <channel> <modes> [<param>...]).
  */
-void handleModeCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handleModeCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // MODE_HPP
@@ -0,0 +1,41 @@
+#include "Names.hpp"
+#include "../include/Channel.hpp"
+#include "../include/Replies.hpp"
+#include "../include/Server.hpp"
+#include <string>
+
+/**
+ * @brief Handles the NAMES command from a client.
+ *
+ * For each channel of the comma-separated list, sends its member list (see
+ * `sendNames()`, which reuses the channel's cached rendering). A channel
+ * that does not exist only gets the closing 366, as the RFC specifies.
+ * Without parameters, only `366 <nick> * :End of /NAMES list` is sent:
+ * listing every channel of the server at once is left to LIST.
+ *
+ * @param server   Pointer to the Server instance.
+ * @param fd       File descriptor of the requesting client.
+ * @param msg      The parsed command.
+ */
+void handleNamesCommand(Server* server, int fd, const IrcMessage& msg)
+{
+    if (msg.paramCount < 1) {
+        Reply(server, fd, RPL_ENDOFNAMES).param("*").send();
+        return;
+    }
+
+    std::string_view list = msg.params[0];
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string channelName(list.substr(0, comma));
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+        if (channelName.empty())
+            continue;
+
+        std::map<std::string, Channel>::iterator it = server->getChannels().find(channelName);
+        if (it == server->getChannels().end())
+            Reply(server, fd, RPL_ENDOFNAMES).param(channelName).send();
+        else
+            sendNames(server, fd, it->second);
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef NAMES_HPP
+#define NAMES_HPP
+#include "../include/IrcMessage.hpp"
+
+class Server;
+
+/**
+ * @brief Handles the NAMES command.
+ *
+ * Lists the members of each requested channel (353 replies, split to fit
+ * the 512-byte line limit), each list ending with a 366.
+ *
+ * @param server Pointer to the Server object.
+ * @param fd File descriptor of the requesting client.
+ * @param msg The parsed command. Expected format: NAMES [<channel>{,<channel>}].
+ */
+void handleNamesCommand(Server* server, int fd, const IrcMessage& msg);
+
+#endif // NAMES_HPP
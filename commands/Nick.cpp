@@ -1,13 +1,13 @@
+#include "../include/IrcMessage.hpp"
 #include "../include/Replies.hpp"
 #include "../include/Server.hpp"
 #include <algorithm>
-#include <set>
 
 /**
  * @brief Sends a nickname change notification to all clients in shared channels.
  *
- * This function ensures that a client receives the nickname change message only once,
- * even if they are in multiple channels.
+ * Every client sharing a channel receives the message once, even if they
+ * share several (see `Server::notifyChannelPeers()`), and so does the client.
  *
  * @param server Pointer to the Server instance.
  * @param client Pointer to the Client whose nickname changed.
@@ -19,27 +19,10 @@ static void broadcastNickChange(Server* server, Client* client,
     const std::string& newNick)
 {
 
-    std::string message = ":" + oldNick + "!" + client->getUsername() + "@" + client->getHost() + " NICK :" + newNick + "\r\n";
+    SharedMessage message = std::make_shared<const std::string>(":" + oldNick + "!" + client->getUsername() + "@" + client->getHost() + " NICK :" + newNick + "\r\n");
 
-    int fd = client->getFd();
-
-    // Use a set to avoid duplicate sends (e.g., if a user is in multiple channels).
-    std::set<int> notifiedClients;
-
-    for (std::map<std::string, Channel>::iterator it = server->getChannels().begin();
-        it != server->getChannels().end(); ++it) {
-        Channel& chan = it->second;
-
-        if (chan.hasClient(fd)) {
-            for (int otherFd : chan.getClients()) {
-                if (otherFd != fd && notifiedClients.insert(otherFd).second) {
-                    send(otherFd, message.c_str(), message.size(), 0);
-                }
-            }
-        }
-    }
-
-    send(fd, message.c_str(), message.size(), 0);
+    server->notifyChannelPeers(client->getFd(), message);
+    server->safeSend(client->getFd(), message);
 }
 
 /**
@@ -50,36 +33,28 @@ static void broadcastNickChange(Server* server, Client* client,
  *
  * @param server Pointer to the Server instance.
  * @param fd The client's file descriptor.
- * @param tokens The parsed command tokens.
- * @param command The full command string (unused).
+ * @param msg The parsed command.
  */
-void handleNickCommand(Server* server, int fd,
-    const std::vector<std::string>& tokens,
-    const std::string& /*command*/)
+void handleNickCommand(Server* server, int fd, const IrcMessage& msg)
 {
-    if (tokens.size() < 2) {
-        std::string reply = "431 :No nickname given\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+    if (msg.paramCount < 1) {
+        Reply(server, fd, ERR_NONICKNAMEGIVEN).send();
         return;
     }
 
-    std::string newNick = tokens[1];
+    std::string newNick(msg.params[0]);
 
-    for (const auto& pair : server->getClients()) {
-        if (pair.first != fd && pair.second->getNickname() == newNick) {
-            std::string reply = "433 * " + newNick + " :Nickname is already in use\r\n";
-            send(fd, reply.c_str(), reply.size(), 0);
-            return;
-        }
-    }
-
-    Client* client = server->getClients()[fd].get();
+    Client* client = server->getClients()[fd];
     if (!client)
         return;
 
     std::string oldNick = client->getNickname();
 
-    client->setNickname(newNick);
+    // Nicknames are unique up to RFC 1459 case; the index rejects a taken one.
+    if (!server->setClientNickname(fd, newNick)) {
+        Reply(server, fd, ERR_NICKNAMEINUSE).param(newNick).send();
+        return;
+    }
 
     AuthState& st = client->authState;
 
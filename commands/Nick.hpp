@@ -1,7 +1,6 @@
 #ifndef NICK_HPP
 #define NICK_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 /**
  * @brief Forward declaration of the Server class.
@@ -18,9 +17,8 @@ class Server;
  *
  * @param server Pointer to the Server object that manages the IRC server.
  * @param fd The file descriptor of the client issuing the NICK command.
- * @param tokens A vector of strings representing the tokenized command arguments (expected format: "NICK" followed by <newNick>).
- * @param command The complete command string received from the client.
+ * @param msg The parsed command (expected format: NICK <newNick>).
  */
-void handleNickCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handleNickCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // NICK_HPP
@@ -1,72 +1,42 @@
 #include "Part.hpp"
 #include <string>
+#include "../include/Replies.hpp"
 #include "../include/Server.hpp"
 
-void handlePartCommand(Server* server, int fd,
-                       const std::vector<std::string>& tokens,
-                       const std::string& /*command*/)
+void handlePartCommand(Server* server, int fd, const IrcMessage& msg)
 {
-    // Check if the client is fully registered
-    if (server->getClients()[fd]->authState != AUTH_REGISTERED)
-    {
-        std::string reply =
-            "451 :You have not registered\r\n";  // Error: Client not registered
-        send(fd, reply.c_str(), reply.size(), 0);
-        return;
-    }
-
-    // Ensure the command has enough parameters (at least the channel name)
-    if (tokens.size() < 2)
-    {
-        std::string reply =
-            "461 PART :Not enough parameters\r\n";  // Error: Missing parameters
-        send(fd, reply.c_str(), reply.size(), 0);
-        return;
-    }
-
-    std::string channelName =
-        tokens[1];  // Extract the channel name from the command
+    std::string channelName(
+        msg.params[0]);  // Extract the channel name from the command
 
     // Find the channel in the server's channel map
     auto it = server->getChannels().find(channelName);
     if (it == server->getChannels().end())
     {
-        std::string reply =
-            "403 " + channelName +
-            " :No such channel\r\n";  // Error: Channel does not exist
-        send(fd, reply.c_str(), reply.size(), 0);
+        // Error: Channel does not exist
+        Reply(server, fd, ERR_NOSUCHCHANNEL).param(channelName).send();
         return;
     }
 
     // Check if the client is part of the channel
-    if (!it->second.hasClient(fd))
+    ClientId id = server->getClients()[fd]->getId();
+    if (!it->second.hasClient(id))
     {
-        std::string reply =
-            "442 " + channelName +
-            " :You're not on that channel\r\n";  // Error: Client not in channel
-        send(fd, reply.c_str(), reply.size(), 0);
+        // Error: Client not in channel
+        Reply(server, fd, ERR_NOTONCHANNEL).param(channelName).send();
         return;
     }
 
     // Check: if user is last operator, disable exit
-    if (it->second.isOperator(fd))
+    if (it->second.isOperator(id))
     {
         size_t totalUsers =
             it->second.getClients().size();  // count users in channel
         if (totalUsers > 1)
         {
-            int operatorCount = 0;
-            for (int clientFd : it->second.getClients())
+            if (it->second.getOperatorCount() == 1)
             {
-                if (it->second.isOperator(clientFd)) operatorCount++;
-            }
-
-            if (operatorCount == 1)
-            {
-                std::string reply =
-                    "482 " + channelName +
-                    " :Cannot leave, you are the last operator\r\n";
-                send(fd, reply.c_str(), reply.size(), 0);
+                Reply(server, fd, ERR_CHANOPRIVSNEEDED).param(channelName)
+                    .text("Cannot leave, you are the last operator").send();
                 return;
             }
         }
@@ -74,32 +44,25 @@ void handlePartCommand(Server* server, int fd,
 
     // Check if a part message was provided; if not, use the default "Leaving"
     // message
-    std::string partMessage = tokens.size() > 2 ? tokens[2] : "Leaving";
+    std::string partMessage =
+        msg.paramCount > 1 ? std::string(msg.params[1]) : "Leaving";
 
     // Construct the PART message to be broadcast to all channel members
-    Client* c = server->getClients()[fd].get();
+    Client* c = server->getClients()[fd];
     std::string nick = c->getNickname();
     std::string user = c->getUsername();
     std::string host = c->getHost(); 
 
     std::string prefix = ":" + nick + "!" + user + "@" + host; 
 
-    std::string fullPartMessage = prefix + 
-        " PART " + channelName + " :" + partMessage + "\r\n";
+    SharedMessage fullPartMessage = std::make_shared<const std::string>(prefix +
+        " PART " + channelName + " :" + partMessage + "\r\n");
 
 
     // Notify all clients in the channel about the PART event
-    for (int cli_fd : it->second.getClients())
-    {
-        send(cli_fd, fullPartMessage.c_str(), fullPartMessage.size(), 0);
-    }
-
-    // Remove the client from the channel
-    it->second.removeClient(fd);
+    server->sendToChannel(it->second, fullPartMessage);
 
-    // If the channel becomes empty after the client leaves, delete the channel
-    if (it->second.getClients().empty())
-    {
-        server->getChannels().erase(it);  // Remove the channel from the server
-    }
+    // Remove the client from the channel (deleting the channel if it becomes
+    // empty)
+    server->leaveChannel(fd, channelName);
 }
@@ -1,9 +1,8 @@
 #ifndef PART_HPP
 #define PART_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 class Server;
-void handlePartCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handlePartCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // PART_HPP
@@ -1,5 +1,6 @@
 #include "Pass.hpp"
 #include <string>
+#include "../include/Replies.hpp"
 #include "../include/Server.hpp"
 
 /**
@@ -9,32 +10,24 @@
  * authenticate with the server. It checks that the required password parameter
  * is provided, compares it with the server's password, and, if they match,
  * updates the client's authentication state to WAITING_FOR_NICK. If the
- * password is incorrect or if not enough parameters are provided, the
- * appropriate error message is sent, and in the case of an incorrect password,
- * the client is removed.
+ * password is incorrect, an error message is sent and the client is removed.
+ * A PASS after registration has started is rejected.
  *
  * @param server Pointer to the Server object managing the IRC server.
  * @param fd The file descriptor of the client issuing the PASS command.
- * @param tokens A vector of strings representing the tokenized command
- * arguments (expected: "PASS" followed by <password>).
- * @param command The complete command string received from the client (unused
- * in this implementation).
+ * @param msg The parsed command (expected: PASS <password>).
  */
-void handlePassCommand(Server* server, int fd,
-                       const std::vector<std::string>& tokens,
-                       const std::string& /*command*/)
+void handlePassCommand(Server* server, int fd, const IrcMessage& msg)
 {
-    if (tokens.size() < 2)
+    if (server->getClients()[fd]->authState != NOT_REGISTERED)
     {
-        std::string reply = "461 PASS :Not enough parameters\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+        server->mayNotRegistered(fd);
         return;
     }
 
-    if (tokens[1] != server->getPassword())
+    if (msg.params[0] != server->getPassword())
     {
-        std::string reply = "464 PASS :Password incorrect\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+        Reply(server, fd, ERR_PASSWDMISMATCH).send();
         server->removeClient(fd);
         return;
     }
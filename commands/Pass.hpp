@@ -1,7 +1,6 @@
 #ifndef PASS_HPP
 #define PASS_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 /**
  * @brief Forward declaration of the Server class.
@@ -19,12 +18,8 @@ class Server;
  *
  * @param server Pointer to the Server object managing the IRC server.
  * @param fd The file descriptor of the client issuing the PASS command.
- * @param tokens A vector of strings containing the tokenized command arguments
- * (expected format: "PASS" followed by <password>).
- * @param command The complete command string received from the client.
+ * @param msg The parsed command (expected format: PASS <password>).
  */
-void handlePassCommand(Server* server, int fd,
-                       const std::vector<std::string>& tokens,
-                       const std::string&              command);
+void handlePassCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif  // PASS_HPP
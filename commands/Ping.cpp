@@ -0,0 +1,18 @@
+#include "Ping.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Server.hpp"
+#include <string>
+
+void handlePingCommand(Server* server, int fd, const IrcMessage& msg)
+{
+    std::string pong = "PONG ";
+    if (msg.paramCount > 0)
+        pong += msg.params[0];
+    pong += "\r\n";
+    server->safeSend(fd, pong);
+    LOG_DEBUG("Sending: " << pong.substr(0, pong.size() - 2));
+}
+
+void handlePongCommand(Server* /*server*/, int /*fd*/, const IrcMessage& /*msg*/)
+{
+}
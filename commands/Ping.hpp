@@ -0,0 +1,28 @@
+#ifndef PING_HPP
+#define PING_HPP
+#include "../include/IrcMessage.hpp"
+
+class Server;
+
+/**
+ * @brief Handles the PING command: answers with a PONG echoing its token.
+ *
+ * @param server Pointer to the Server object.
+ * @param fd File descriptor of the client.
+ * @param msg The parsed command (`PING [<token>]`).
+ */
+void handlePingCommand(Server* server, int fd, const IrcMessage& msg);
+
+/**
+ * @brief Handles the PONG command (the keepalive reply).
+ *
+ * Receiving any line already refreshed the client's activity, so there is
+ * nothing left to do.
+ *
+ * @param server Pointer to the Server object.
+ * @param fd File descriptor of the client.
+ * @param msg The parsed command (unused).
+ */
+void handlePongCommand(Server* server, int fd, const IrcMessage& msg);
+
+#endif // PING_HPP
@@ -1,105 +1,176 @@
 #include "Privmsg.hpp"
+#include "../include/Replies.hpp"
 #include "../include/Server.hpp"
 #include <string>
+#include <vector>
+
+/** @brief A target served on the calling thread, once the big channels were handed out. */
+struct InlineTarget
+{
+    const Channel* channel; ///< The channel, or `NULL` for a nickname target.
+    ClientId client; ///< The client of a nickname target.
+    SharedMessage line; ///< The line naming this target.
+};
+
+/** @brief Whether a client is on one of the channels handed to the shards. */
+static bool isSpread(const std::vector<const Channel*>& spread, ClientId id)
+{
+    for (size_t i = 0; i < spread.size(); ++i) {
+        if (spread[i]->hasClient(id))
+            return true;
+    }
+    return false;
+}
 
 /**
- * @brief Handles the PRIVMSG command from a client.
+ * @brief Delivers the text of a PRIVMSG or NOTICE to every target it names.
  *
- * This function processes the PRIVMSG command, which is used to send private messages either
- * to a specific user or to a channel. It first verifies that the client is fully registered and 
- * that enough parameters have been provided. 
+ * The first parameter is a comma-separated list of targets, channels and
+ * nicknames mixed, at most `Server::getMaxTargets()` of them. Registration and
+ * the parameter count are checked by the dispatcher.
  *
- * If the target starts with '#' (indicating a channel), it checks that the channel exists and that 
- * the sender is a member of the channel. If the sender is not on the channel, an error message is returned.
+ * The line is serialized once, except for the target field:
+ * `:<nick> <verb> ` and ` :<text>` are built up front and each target only
+ * adds its own name. With a single channel target the line goes through
+ * `Server::sendToChannel()` (so big channels are spread over the shards).
  *
- * The function then extracts the actual message content from the command (after the ':' delimiter) 
- * and sends the message:
- * - For channel messages, it broadcasts the message to all channel members except the sender.
- * - For private messages (target is a nickname), it sends the message directly to the specified user.
+ * With several targets, each recipient gets the message once, even if it is
+ * on several of the channels or also named directly. Channels past the
+ * fan-out threshold are handed to the shards first (`Server::spreadOnce()`),
+ * so a big channel never stalls the calling loop; a recipient on several of
+ * them gets the line of the first. The small channels and the nicknames are
+ * then served inline with `Server::sendOnce()`, skipping the members of the
+ * big channels, and a recipient gets the line of the first target it was
+ * reached by.
+ *
+ * For channel targets, the channel must exist and the sender must be on it;
+ * the sender never receives its own channel message.
+ *
+ * PRIVMSG reports problems with numeric replies (401, 403, 442, 407), one
+ * per failing target, in target order; as the RFC requires, NOTICE never
+ * triggers a reply.
  *
  * @param server Pointer to the Server object managing the IRC server.
- * @param fd The file descriptor of the client issuing the PRIVMSG command.
- * @param tokens A vector of strings containing the tokenized command arguments.
- *               Expected format: "PRIVMSG", <target>, and the message text after a ':'.
- * @param command The complete command string received from the client.
+ * @param fd The file descriptor of the client issuing the command.
+ * @param msg The parsed command: <verb> <target>{,<target>} :<text>.
+ * @param verb "PRIVMSG" or "NOTICE".
+ * @param quiet Whether errors are silently dropped (NOTICE).
  */
-void handlePrivmsgCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command) {
-    // Check if the client is fully registered.
-    if (server->getClients()[fd]->authState != AUTH_REGISTERED) 
-    {
-        std::string reply = "451 :You have not registered\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
-        return;
+static void deliverMessage(Server* server, int fd, const IrcMessage& msg,
+    const char* verb, bool quiet)
+{
+    if (msg.paramCount < 2)
+        return; // Only NOTICE gets here: the dispatcher answers PRIVMSG with 461.
+
+    // Split the target list (empty entries, as in "a,,b", are skipped).
+    std::vector<std::string_view> targets;
+    std::string_view list = msg.params[0];
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view target = list.substr(0, comma);
+        if (!target.empty())
+            targets.push_back(target);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
     }
-    
-    // Check that enough parameters are provided.
-    if (tokens.size() < 3) {
-        std::string reply = "461 PRIVMSG :Not enough parameters\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+    if (targets.size() > server->getMaxTargets()) {
+        if (!quiet)
+            Reply(server, fd, ERR_TOOMANYTARGETS).param(msg.params[0]).send();
         return;
     }
-    
-    // Extract the target from the tokens.
-    std::string target = tokens[1];
-    
-    // If the target is a channel (starts with '#'), ensure the sender is a member.
-    if (!target.empty() && target[0] == '#') {
-        auto channelIt = server->getChannels().find(target);
-        if (channelIt == server->getChannels().end()) {
-            std::string reply = "403 " + target + " :No such channel\r\n";
-            send(fd, reply.c_str(), reply.size(), 0);
-            return;
-        }
-        // If the sender is not part of the channel, send an error.
-        if (!channelIt->second.hasClient(fd)) {
-            std::string reply = "442 " + target + " :You're not on that channel\r\n";
-            send(fd, reply.c_str(), reply.size(), 0);
-            return;
-        }
-    }
-    
-    // Determine the start position of the message text.
-    size_t msgStart = command.find(':');
-    if (msgStart == std::string::npos) {
-        // If ':' is not found, assume the message starts after the target name plus a space.
-        msgStart = command.find(target) + target.size() + 1;
-    } else {
-        // Otherwise, skip the ':' character.
-        msgStart++;
-    }
-    
-    // Extract the message from the command.
-    std::string message = command.substr(msgStart);
-    
-    // If the target is a channel, broadcast the message to all members except the sender.
-    if (!target.empty() && target[0] == '#') 
-    {
-        auto it = server->getChannels().find(target);
-        if (it != server->getChannels().end()) {
-            std::string fullMsg = ":" + server->getClients()[fd]->getNickname() + " PRIVMSG " + target + " :" + message + "\r\n";
-            for (int cli_fd : it->second.getClients()) {
-                if (cli_fd != fd)
-                    send(cli_fd, fullMsg.c_str(), fullMsg.size(), 0);
+
+    Client* sender = server->getClients()[fd];
+    const std::string head = ":" + sender->getNickname() + " " + verb + " ";
+    const std::string tail = " :" + std::string(msg.params[1]) + "\r\n";
+    uint64_t epoch = targets.size() > 1 ? server->newNotifyEpoch() : 0;
+
+    // Check every target in order, handing the big channels to the shards
+    // right away; the rest waits for the second pass.
+    std::vector<const Channel*> spread;
+    std::vector<InlineTarget> inlineTargets;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        std::string target(targets[i]);
+
+        // Channel target: it must exist and the sender must be on it.
+        if (target[0] == '#') {
+            std::map<std::string, Channel>::iterator it = server->getChannels().find(target);
+            if (it == server->getChannels().end()) {
+                if (!quiet)
+                    Reply(server, fd, ERR_NOSUCHCHANNEL).param(target).send();
+                continue;
+            }
+            if (!it->second.hasClient(sender->getId())) {
+                if (!quiet)
+                    Reply(server, fd, ERR_NOTONCHANNEL).param(target).send();
+                continue;
             }
-        } else {
-            std::string reply = "403 " + target + " :No such channel\r\n";
-            send(fd, reply.c_str(), reply.size(), 0);
+
+            SharedMessage line = std::make_shared<const std::string>(head + target + tail);
+            if (!epoch)
+                server->sendToChannel(it->second, line, sender->getId());
+            else if (server->spreadOnce(it->second, line, sender->getId(), epoch))
+                spread.push_back(&it->second);
+            else
+                inlineTargets.push_back(InlineTarget { &it->second, 0, line });
+            continue;
         }
+
+        // Otherwise, treat the target as a nickname and send a private message.
+        int targetFd = server->findClientByNick(target);
+        if (targetFd == -1) {
+            if (!quiet)
+                Reply(server, fd, ERR_NOSUCHNICK).param(target).send();
+            continue;
+        }
+        SharedMessage line = std::make_shared<const std::string>(head + target + tail);
+        if (!epoch)
+            server->safeSend(targetFd, line);
+        else
+            inlineTargets.push_back(InlineTarget { NULL, server->getClients()[targetFd]->getId(), line });
     }
-    // Otherwise, treat the target as a getNickname() and send a private message.
-    else {
-        bool found = false;
-        for (const auto& pair : server->getClients()) {
-            if (pair.second->getNickname() == target) {
-                std::string fullMsg = ":" + server->getClients()[fd]->getNickname() + " PRIVMSG " + target + " :" + message + "\r\n";
-                send(pair.first, fullMsg.c_str(), fullMsg.size(), 0);
-                found = true;
-                break;
-            }
+
+    // Serve the small channels and the nicknames, leaving the members of the
+    // big channels to the shards.
+    for (size_t i = 0; i < inlineTargets.size(); ++i) {
+        const InlineTarget& target = inlineTargets[i];
+        if (!target.channel) {
+            if (!isSpread(spread, target.client))
+                server->sendOnce(target.client, target.line, epoch);
+            continue;
         }
-        if (!found) {
-            std::string reply = "401 " + target + " :No such nick/channel\r\n";
-            send(fd, reply.c_str(), reply.size(), 0);
+        const std::vector<ClientId>& members = target.channel->getClients();
+        for (size_t m = 0; m < members.size(); ++m) {
+            if (members[m] != sender->getId() && !isSpread(spread, members[m]))
+                server->sendOnce(members[m], target.line, epoch);
         }
     }
 }
+
+/**
+ * @brief Handles the PRIVMSG command from a client.
+ *
+ * Sends the text to each user or channel of the target list (see
+ * `deliverMessage()`), answering failures with numeric replies.
+ *
+ * @param server Pointer to the Server object managing the IRC server.
+ * @param fd The file descriptor of the client issuing the PRIVMSG command.
+ * @param msg The parsed command. Expected format: PRIVMSG <target>{,<target>} :<text>.
+ */
+void handlePrivmsgCommand(Server* server, int fd, const IrcMessage& msg)
+{
+    deliverMessage(server, fd, msg, "PRIVMSG", false);
+}
+
+/**
+ * @brief Handles the NOTICE command from a client.
+ *
+ * Same delivery as PRIVMSG, but no reply is ever sent back, so automated
+ * clients cannot loop on each other's errors.
+ *
+ * @param server Pointer to the Server object managing the IRC server.
+ * @param fd The file descriptor of the client issuing the NOTICE command.
+ * @param msg The parsed command. Expected format: NOTICE <target>{,<target>} :<text>.
+ */
+void handleNoticeCommand(Server* server, int fd, const IrcMessage& msg)
+{
+    deliverMessage(server, fd, msg, "NOTICE", true);
+}
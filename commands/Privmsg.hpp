@@ -1,7 +1,6 @@
 #ifndef PRIVMSG_HPP
 #define PRIVMSG_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 /**
  * @brief Forward declaration of the Server class.
@@ -12,18 +11,27 @@ class Server;
  * @brief Handles the PRIVMSG command.
  *
  * This function processes the PRIVMSG command, which allows a client to send a private message
- * to another user or broadcast a message to a channel. It performs validation checks such as
- * ensuring the client is fully registered and that the correct parameters are provided. In the
- * case of a channel message (target begins with '#'), it verifies that the sender is a member of
- * the channel before forwarding the message to all channel members (except the sender). For a
- * private message, it sends the message directly to the target client.
+ * to other users or broadcast a message to channels. The target is a comma-separated list of
+ * nicknames and channels (up to the server's MAXTARGETS). In the case of a channel target
+ * (beginning with '#'), it verifies that the sender is a member of the channel before forwarding
+ * the message to all channel members (except the sender). For a nickname, it sends the message
+ * directly to the target client. A recipient reached through several targets gets it once.
  *
  * @param server Pointer to the Server object managing the IRC server.
  * @param fd The file descriptor of the client issuing the PRIVMSG command.
- * @param tokens A vector of strings representing the tokenized command arguments.
- *               Expected format: "PRIVMSG", <target>, followed by the message text after a ':'.
- * @param command The complete command string received from the client.
+ * @param msg The parsed command. Expected format: PRIVMSG <target>{,<target>} :<text>.
  */
-void handlePrivmsgCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handlePrivmsgCommand(Server* server, int fd, const IrcMessage& msg);
+
+/**
+ * @brief Handles the NOTICE command.
+ *
+ * Delivered exactly like PRIVMSG, but errors are never reported back to the sender.
+ *
+ * @param server Pointer to the Server object managing the IRC server.
+ * @param fd The file descriptor of the client issuing the NOTICE command.
+ * @param msg The parsed command. Expected format: NOTICE <target>{,<target>} :<text>.
+ */
+void handleNoticeCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // PRIVMSG_HPP
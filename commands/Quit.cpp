@@ -1,5 +1,4 @@
 #include "Quit.hpp"
-#include <sstream>
 #include <string>
 #include <vector>
 #include "../include/Channel.hpp"
@@ -11,25 +10,23 @@
  *
  * This function processes the QUIT command by:
  * - Constructing a quit message, including a reason if provided.
- * - Broadcasting the quit message to all clients in shared channels.
- * - Removing the client from all channels and erasing empty channels.
+ * - Sending the quit message once to every client sharing a channel.
+ * - Removing the client from its channels and erasing empty channels; only
+ *   the channels recorded on the client are visited.
  * - Sending the quit message directly to the quitting client.
  * - Removing the client from the server.
  *
  * @param server Pointer to the Server instance.
  * @param fd The file descriptor of the quitting client.
- * @param tokens The parsed command tokens (e.g., "QUIT", "reason ...").
- * @param command The full command string (unused).
+ * @param msg The parsed command (e.g., "QUIT :reason ...").
  */
-void handleQuitCommand(Server* server, int fd,
-                       const std::vector<std::string>& tokens,
-                       const std::string& /*command*/)
+void handleQuitCommand(Server* server, int fd, const IrcMessage& msg)
 {
     // Check if the client exists in the server's client list.
-    if (server->getClients().find(fd) == server->getClients().end()) return;
+    if (!server->getClients()[fd]) return;
 
     // Retrieve the quitting client's details.
-    Client*     client = server->getClients()[fd].get();
+    Client*     client = server->getClients()[fd];
     std::string nick   = client->getNickname();
     std::string user   = client->getUsername().empty() ? "unknown" : client->getUsername();
     std::string host   = client->getHost();
@@ -39,15 +36,9 @@ void handleQuitCommand(Server* server, int fd,
 
     // Construct the quit reason.
     std::string quitReason;
-    if (tokens.size() > 1)
+    if (msg.paramCount > 0)
     {
-        std::ostringstream oss;
-        for (size_t i = 1; i < tokens.size(); ++i)
-        {
-            if (i > 1) oss << " ";
-            oss << tokens[i];
-        }
-        quitReason = oss.str();
+        quitReason = std::string(msg.params[0]);
     }
     else
     {
@@ -55,47 +46,22 @@ void handleQuitCommand(Server* server, int fd,
     }
 
     // Construct the full QUIT message to be sent to all relevant clients.
-    std::string quitMsg = prefix + " QUIT :" + quitReason + "\r\n";
+    SharedMessage quitMsg = std::make_shared<const std::string>(prefix + " QUIT :" + quitReason + "\r\n");
 
-    // List of channels that should be removed if they become empty.
-    std::vector<std::string> channelsToRemove;
+    // Notify everyone sharing a channel, once each, even across several channels.
+    server->notifyChannelPeers(fd, quitMsg);
 
-    // Iterate over all channels on the server to notify other clients and remove the quitter.
-    for (auto& pair : server->getChannels())
+    // Leave only the channels the quitting client has joined (leaving one
+    // removes it from the client's set, so always take a copy of the first),
+    // erasing those left empty.
+    while (!client->channels.empty())
     {
-        Channel& chan = pair.second;
-
-        // Check if the quitting client is a member of the channel.
-        if (chan.hasClient(fd))
-        {
-            // Broadcast the QUIT message to all other clients in the channel.
-            for (int cli_fd : chan.getClients())
-            {
-                if (cli_fd != fd) // Skip sending to the quitting client.
-                {
-                    send(cli_fd, quitMsg.c_str(), quitMsg.size(), 0);
-                }
-            }
-
-            // Remove the quitting client from the channel.
-            chan.removeClient(fd);
-
-            // If the channel becomes empty after removal, mark it for deletion.
-            if (chan.getClients().empty())
-            {
-                channelsToRemove.push_back(pair.first);
-            }
-        }
-    }
-
-    // Remove all empty channels from the server.
-    for (const std::string& chanName : channelsToRemove)
-    {
-        server->getChannels().erase(chanName);
+        std::string chanName = *client->channels.begin();
+        server->leaveChannel(fd, chanName);
     }
 
     // Send the QUIT message directly to the quitting client.
-    send(fd, quitMsg.c_str(), quitMsg.size(), 0);
+    server->safeSend(fd, quitMsg);
 
     // Remove the client from the server's client list.
     server->removeClient(fd);
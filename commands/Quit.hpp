@@ -1,7 +1,6 @@
 #ifndef QUIT_HPP
 #define QUIT_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 /**
  * @brief Forward declaration of the Server class.
@@ -18,13 +17,8 @@ class Server;
  *
  * @param server Pointer to the Server object managing the IRC server.
  * @param fd The file descriptor of the client issuing the QUIT command.
- * @param tokens A vector of tokenized command arguments (unused in this
- * implementation).
- * @param command The complete command string received from the client (unused
- * in this implementation).
+ * @param msg The parsed command (expected format: QUIT [:<reason>]).
  */
-void handleQuitCommand(Server* server, int fd,
-                       const std::vector<std::string>& tokens,
-                       const std::string&              command);
+void handleQuitCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif  // QUIT_HPP
@@ -1,15 +1,16 @@
 #include "Topic.hpp"
-#include <sys/socket.h>
 #include <string>
+#include "../include/Replies.hpp"
 #include "../include/Server.hpp"
 
 /**
  * @brief Handles the TOPIC command from a client.
  *
  * The TOPIC command is used to either view or change the topic of a channel.
- * If a colon (':') is present in the command following the channel name, the
- * command is interpreted as a request to change the topic. Otherwise, it is
- * assumed that the client wants to view the current topic.
+ * If a second parameter follows the channel name (normally a trailing one,
+ * which may be empty to clear the topic), the command is interpreted as a
+ * request to change the topic. Otherwise, it is assumed that the client wants
+ * to view the current topic.
  *
  * When changing the topic, if the channel is set to topic-restricted mode, the
  * client must be an operator. The updated topic is then broadcast to all
@@ -18,84 +19,52 @@
  *
  * @param server Pointer to the Server object managing the IRC server.
  * @param fd The file descriptor of the client issuing the TOPIC command.
- * @param tokens A vector of strings containing the tokenized command arguments.
- *               Expected tokens are: "TOPIC", <channel>, and optionally a new
- * topic (preceded by a colon).
- * @param command The complete command string as received from the client.
+ * @param msg The parsed command. Expected parameters are: <channel>, and
+ * optionally a new topic (preceded by a colon).
  */
-void handleTopicCommand(Server* server, int fd,
-                        const std::vector<std::string>& tokens,
-                        const std::string&              command)
+void handleTopicCommand(Server* server, int fd, const IrcMessage& msg)
 {
-    // Verify that the client is fully registered.
-    if (server->getClients()[fd]->authState != AUTH_REGISTERED)
-    {
-        std::string reply = "451 :You have not registered\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
-        return;
-    }
-
-    // Ensure that at least the channel name is provided.
-    if (tokens.size() < 2)
-    {
-        std::string reply = "461 TOPIC :Not enough parameters\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
-        return;
-    }
-
-    // Extract the channel name from the tokens.
-    std::string channelName = tokens[1];
+    // Extract the channel name from the parameters.
+    std::string channelName(msg.params[0]);
 
     // Look for the channel in the server's channel map.
     auto it = server->getChannels().find(channelName);
     if (it == server->getChannels().end())
     {
-        std::string reply = "403 " + channelName + " :No such channel\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+        Reply(server, fd, ERR_NOSUCHCHANNEL).param(channelName).send();
         return;
     }
 
-    // Check if a new topic is specified in the command (i.e., there is a
-    // colon).
-    size_t topicPos = command.find(':');
-    if (topicPos != std::string::npos)
+    // Check if a new topic is specified in the command.
+    if (msg.paramCount > 1)
     {
-        // Skip the colon.
-        topicPos++;
         // Extract the new topic.
-        std::string newTopic = command.substr(topicPos);
+        std::string newTopic(msg.params[1]);
 
         // If the channel is topic-restricted, verify that the client is an
         // operator.
-        if (it->second.isTopicRestricted() && !it->second.isOperator(fd))
+        if (it->second.isTopicRestricted() && !it->second.isOperator(server->getClients()[fd]->getId()))
         {
-            std::string reply =
-                "482 " + channelName + " :You're not channel operator\r\n";
-            send(fd, reply.c_str(), reply.size(), 0);
+            Reply(server, fd, ERR_CHANOPRIVSNEEDED).param(channelName).send();
             return;
         }
         // Set the new topic for the channel.
         it->second.setTopic(newTopic);
         // Construct a topic change notification message.
-        std::string topicMsg = ":" + server->getClients()[fd]->getNickname() +
-                               " TOPIC " + channelName + " :" + newTopic +
-                               "\r\n";
+        SharedMessage topicMsg = std::make_shared<const std::string>(
+            ":" + server->getClients()[fd]->getNickname() + " TOPIC " +
+            channelName + " :" + newTopic + "\r\n");
         // Send the updated topic to all members of the channel.
-        for (int cli_fd : it->second.getClients())
-        {
-            send(cli_fd, topicMsg.c_str(), topicMsg.size(), 0);
-        }
+        server->sendToChannel(it->second, topicMsg);
     }
     else
     {
         // If no new topic is provided, the client is requesting to view the
         // current topic.
-        std::string currentTopic = it->second.getTopic();
-        std::string topicReply;
+        const std::string& currentTopic = it->second.getTopic();
         if (currentTopic.empty())
-            topicReply = "331 " + channelName + " :No topic is set\r\n";
+            Reply(server, fd, RPL_NOTOPIC).param(channelName).send();
         else
-            topicReply = "332 " + channelName + " :" + currentTopic + "\r\n";
-        send(fd, topicReply.c_str(), topicReply.size(), 0);
+            Reply(server, fd, RPL_TOPIC).param(channelName).text(currentTopic).send();
     }
 }
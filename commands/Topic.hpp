@@ -1,7 +1,6 @@
 #ifndef TOPIC_HPP
 #define TOPIC_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 /**
  * @brief Forward declaration of the Server class.
@@ -12,7 +11,7 @@ class Server;
  * @brief Handles the TOPIC command from a client.
  *
  * This function processes the TOPIC command, which is used to view or change a channel's topic.
- * When a new topic is provided (indicated by the presence of a ':' in the command), the function
+ * When a new topic is provided (a trailing parameter), the function
  * verifies (if necessary) that the client has operator privileges when the channel is topic-restricted,
  * then updates the channel topic and notifies all channel members.
  *
@@ -20,10 +19,9 @@ class Server;
  *
  * @param server Pointer to the Server object that manages the IRC server.
  * @param fd The file descriptor of the client issuing the TOPIC command.
- * @param tokens A vector of strings containing the tokenized command arguments.
- *               Expected tokens: "TOPIC", <channel>, and (optionally) the new topic text (following a colon).
- * @param command The complete command string received from the client.
+ * @param msg The parsed command. Expected format: TOPIC <channel> [:<new topic>];
+ *            a trailing parameter, even an empty one, sets the topic.
  */
-void handleTopicCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handleTopicCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // TOPIC_HPP
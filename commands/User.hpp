@@ -1,7 +1,6 @@
 #ifndef USER_HPP
 #define USER_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 /**
  * @brief Forward declaration of the Server class.
@@ -19,10 +18,9 @@ class Server;
  *
  * @param server Pointer to the Server object managing the IRC server.
  * @param fd The file descriptor of the client issuing the USER command.
- * @param tokens A vector of strings representing the tokenized command arguments. 
- *               The expected format is: "USER" <username> ... (other parameters are accepted but ignored).
- * @param command The complete command string received from the client.
+ * @param msg The parsed command. The expected format is:
+ *            USER <username> <mode> <unused> :<realname>.
  */
-void handleUserCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handleUserCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // USER_HPP
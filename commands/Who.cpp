@@ -2,9 +2,8 @@
 #include "../include/Server.hpp"
 #include "../include/Client.hpp"
 #include "../include/Channel.hpp"
-#include <sstream>
+#include "../include/Replies.hpp"
 #include <string>
-#include <sys/socket.h>
 
 /**
  * @brief Handles the WHO command from a client.
@@ -15,7 +14,7 @@
  * 2. Omitted or "*" - Lists all users connected to the server.
  *
  * The function follows these steps:
- * - **Extract the target** from the command tokens (if provided).
+ * - **Extract the target** from the command parameters (if provided).
  * - **If a channel is specified**:
  *   - Check if the channel exists. If not, send an error (403).
  *   - Iterate over all clients in the channel and send WHO information.
@@ -25,22 +24,16 @@
  *
  * @param server Pointer to the Server instance.
  * @param fd The file descriptor of the client issuing the WHO command.
- * @param tokens Vector of strings containing the parsed command arguments.
- *               Expected format: `"WHO" [<target>]`
- * @param command The full command string (unused).
+ * @param msg The parsed command.
+ *            Expected format: `WHO [<target>]`
  */
-void handleWhoCommand(Server* server, int fd, 
-                      const std::vector<std::string>& tokens, 
-                      const std::string& command) 
+void handleWhoCommand(Server* server, int fd, const IrcMessage& msg) 
 {
-    (void)command; // Unused parameter
-
-    std::string reply;
     std::string target;
 
-    // Step 1: Extract target from tokens if provided
-    if (tokens.size() >= 2) {
-        target = tokens[1];
+    // Step 1: Extract target from the parameters if provided
+    if (msg.paramCount >= 1) {
+        target = std::string(msg.params[0]);
     }
 
     // Step 2: Handle WHO for a channel target (e.g., "#channel")
@@ -51,47 +44,38 @@ void handleWhoCommand(Server* server, int fd,
         if (it == server->getChannels().end()) 
         {
             // Send error: No such channel (403)
-            reply = "403 " + target + " :No such channel\r\n";
-            send(fd, reply.c_str(), reply.size(), 0);
+            Reply(server, fd, ERR_NOSUCHCHANNEL).param(target).send();
             return;
         }
 
         // Iterate through all clients in the channel
-        for (int client_fd : it->second.getClients()) 
+        for (ClientId member : it->second.getClients()) 
         {
-            Client* client = server->getClients()[client_fd].get();
-            std::ostringstream oss;
+            Client* client = server->getClients().find(member);
 
             // Format WHO response (352)
-            oss << "352 " << server->getClients()[fd]->getNickname() << " " 
-                << target << " " << client->getUsername() << " " 
-                << client->getHost() << " " << server->getServerName() << " " 
-                << client->getNickname() << " H :0 " << client->getUsername() << "\r\n";
-
-            reply = oss.str();
-            send(fd, reply.c_str(), reply.size(), 0);
+            Reply(server, fd, RPL_WHOREPLY).param(target).param(client->getUsername())
+                .param(client->getHost()).param(server->getServerName())
+                .param(client->getNickname()).param("H")
+                .text("0 ").text(client->getUsername()).send();
         }
     }
     else 
     {
         // Step 3: Handle WHO for all connected users (* or no target)
-        for (const auto& pair : server->getClients()) 
+        const std::vector<int>& fds = server->getClients().fds();
+        for (size_t i = 0; i < fds.size(); ++i) 
         {
-            Client* client = pair.second.get();
-            std::ostringstream oss;
+            Client* client = server->getClients()[fds[i]];
 
             // Format WHO response (352) for all users
-            oss << "352 " << server->getClients()[fd]->getNickname() << " * " 
-                << client->getUsername() << " " << client->getHost() << " " 
-                << server->getServerName() << " " << client->getNickname() 
-                << " H :0 " << client->getUsername() << "\r\n";
-
-            reply = oss.str();
-            send(fd, reply.c_str(), reply.size(), 0);
+            Reply(server, fd, RPL_WHOREPLY).param("*").param(client->getUsername())
+                .param(client->getHost()).param(server->getServerName())
+                .param(client->getNickname()).param("H")
+                .text("0 ").text(client->getUsername()).send();
         }
     }
 
     // Step 4: Send End of WHO list message (315)
-    reply = "315 " + server->getClients()[fd]->getNickname() + " :End of WHO list\r\n";
-    send(fd, reply.c_str(), reply.size(), 0);
+    Reply(server, fd, RPL_ENDOFWHO).send();
 }
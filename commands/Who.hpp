@@ -1,7 +1,6 @@
 #ifndef WHO_HPP
 #define WHO_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 class Server;
 
@@ -13,9 +12,8 @@ class Server;
  *
  * @param server Pointer to the Server object.
  * @param fd File descriptor of the requesting client.
- * @param tokens Tokenized command arguments.
- * @param command The complete command string.
+ * @param msg The parsed command (`WHO [<target>]`).
  */
-void handleWhoCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handleWhoCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // WHO_HPP
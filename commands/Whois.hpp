@@ -1,7 +1,6 @@
 #ifndef WHOIS_HPP
 #define WHOIS_HPP
-#include <string>
-#include <vector>
+#include "../include/IrcMessage.hpp"
 
 class Server;
 
@@ -12,9 +11,8 @@ class Server;
  *
  * @param server Pointer to the Server object.
  * @param fd File descriptor of the requesting client.
- * @param tokens Tokenized command arguments.
- * @param command The complete command string.
+ * @param msg The parsed command (`WHOIS <nickname>`).
  */
-void handleWhoisCommand(Server* server, int fd, const std::vector<std::string>& tokens, const std::string& command);
+void handleWhoisCommand(Server* server, int fd, const IrcMessage& msg);
 
 #endif // WHOIS_HPP
@@ -1,16 +1,43 @@
 #ifndef CHANNEL_HPP
 #define CHANNEL_HPP
+#include "Client.hpp"
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
+/**
+ * @brief Per-member status bits, packed into one byte per member.
+ */
+enum MemberFlag
+{
+    MEMBER_OPERATOR = 0x01 ///< Channel operator (`+o`, shown as '@').
+};
+
+/** @brief An immutable list of member handles, shared by the shards delivering to them. */
+typedef std::shared_ptr<const std::vector<ClientId>> MemberList;
+
 /**
  * @brief Represents an IRC channel.
  *
  * The Channel class encapsulates the state and functionality associated
  * with an IRC channel, including its name, topic, members, modes, and operator
- * list.
+ * status.
+ *
+ * Members live in one table:
+ * - `_clients` and `_memberFlags` are dense, parallel arrays (member handle
+ *   and its `MemberFlag` bits), so a broadcast walks contiguous memory.
+ * - `_index` is an open-addressing hash table (linear probing) from handle to the
+ *   member's position in the dense arrays, so membership and operator checks,
+ *   joins and parts are O(1). Removal swaps the last member into the hole,
+ *   which does not preserve join order.
+ *
+ * The channel also caches its rendered NAMES list (see `getCachedNames()`),
+ * so replying to a JOIN or NAMES does not look every member up again. A join
+ * with a known nickname appends to the cache; any other membership or
+ * operator change drops it.
  */
 class Channel
 {
@@ -33,22 +60,28 @@ public:
     ~Channel();
 
     /** @brief Retrieves the channel name. */
-    std::string getName() const;
+    const std::string& getName() const;
 
-    /** @brief Adds a client to the channel if they are not already a member. */
-    void addClient(int fd);
+    /**
+     * @brief Adds a client to the channel if they are not already a member.
+     *
+     * @param id The client's handle.
+     * @param nick The client's nickname, used to patch the NAMES cache; if
+     * empty, the cache is dropped instead.
+     */
+    void addClient(ClientId id, std::string_view nick = std::string_view());
 
     /** @brief Removes a client from the channel. */
-    void removeClient(int fd);
+    void removeClient(ClientId id);
 
     /** @brief Checks if a client is a member of the channel. */
-    bool hasClient(int fd) const;
+    bool hasClient(ClientId id) const;
 
     /** @brief Sets the channel topic. */
     void setTopic(const std::string& topic);
 
     /** @brief Retrieves the current channel topic. */
-    std::string getTopic() const;
+    const std::string& getTopic() const;
 
     /**
      * @brief Sets or removes a mode for the channel.
@@ -70,16 +103,22 @@ public:
     bool hasMode(char mode) const;
 
     /** @brief Retrieves the list of clients in the channel. */
-    const std::vector<int>& getClients() const;
+    const std::vector<ClientId>& getClients() const;
 
     /** @brief Grants operator status to a client. */
-    void addOperator(int fd);
+    void addOperator(ClientId id);
 
     /** @brief Revokes operator status from a client. */
-    void removeOperator(int fd);
+    void removeOperator(ClientId id);
 
     /** @brief Checks if a client is an operator in the channel. */
-    bool isOperator(int fd) const;
+    bool isOperator(ClientId id) const;
+
+    /** @brief Returns how many members are operators. */
+    size_t getOperatorCount() const { return _operatorCount; }
+
+    /** @brief Returns the `MemberFlag` bits of a member (0 for non-members). */
+    unsigned char getMemberFlags(ClientId id) const;
 
     /** @brief Checks if the channel is in invite-only mode (`+i`). */
     bool isInviteOnly() const { return _inviteOnly; }
@@ -94,17 +133,57 @@ public:
     int getUserLimit() const { return _userLimit; }
 
     /** @brief Invites a client to the channel. */
-    void inviteClient(int fd);
+    void inviteClient(ClientId id);
 
     /** @brief Checks if a client has been invited. */
-    bool isInvited(int fd) const;
+    bool isInvited(ClientId id) const;
 
     /** @brief Removes an invite for a client. */
-    void removeInvite(int fd);
+    void removeInvite(ClientId id);
+
+    /** @brief Retrieves the invited clients (some of which may have left the server). */
+    const std::set<ClientId>& getInvites() const;
+
+    /**
+     * @brief Returns the members grouped by owning shard, or `NULL` if it must be rebuilt.
+     *
+     * Entry `i` lists the members owned by shard `i` (see `Server::sendToChannel()`).
+     * Joins and parts drop it.
+     */
+    const std::vector<MemberList>* getMembersByShard() const { return _byShardValid ? &_byShard : NULL; }
+
+    /** @brief Stores freshly grouped members (see `getMembersByShard()`). */
+    void setMembersByShard(std::vector<MemberList> byShard);
+
+    /**
+     * @brief Returns the cached NAMES list, or `NULL` if it must be rebuilt.
+     *
+     * The list is every member's nickname, operators prefixed with '@',
+     * separated by single spaces, in `getClients()` order.
+     */
+    const std::string* getCachedNames() const { return _namesValid ? &_names : NULL; }
+
+    /** @brief Stores a freshly rendered NAMES list (see `getCachedNames()`). */
+    void setCachedNames(std::string names);
+
+    /** @brief Drops the NAMES cache, e.g. because a member changed nickname. */
+    void invalidateNames();
 
 private:
+    /** @brief Returns the `_index` slot holding `id`, or the empty slot where it would go. */
+    size_t findSlot(ClientId id) const;
+
+    /** @brief Empties an `_index` slot, shifting back the entries probed past it. */
+    void eraseSlot(size_t slot);
+
+    /** @brief Doubles `_index` and re-inserts every member. */
+    void growIndex();
+
     std::string _name;                 ///< Channel name.
-    std::vector<int> _clients;          ///< List of clients in the channel.
+    std::vector<ClientId> _clients;     ///< Member handles, dense (see the class notes).
+    std::vector<unsigned char> _memberFlags; ///< `MemberFlag` bits, parallel to `_clients`.
+    std::vector<int> _index;            ///< Open-addressing slots: position in `_clients`, or -1.
+    size_t _operatorCount;              ///< Members with `MEMBER_OPERATOR` set.
     std::string _topic;                 ///< Channel topic.
     std::map<char, bool> _modes;        ///< Map of active channel modes.
 
@@ -112,10 +191,15 @@ private:
     bool _inviteOnly;                    ///< Invite-only mode (`+i`).
     bool _topicRestricted;                ///< Topic restriction mode (`+t`).
     std::string _channelKey;              ///< Channel key for mode `+k`.
-    std::vector<int> _operators;          ///< List of operator client FDs (`+o`).
     int _userLimit;                       ///< User limit for mode `+l`. `0` means no limit.
 
-    std::set<int> _invitedClients;        ///< Set of invited clients.
+    std::set<ClientId> _invitedClients;   ///< Invited clients (handles of departed clients are harmless).
+
+    std::vector<MemberList> _byShard;     ///< Members by owning shard, valid if `_byShardValid`.
+    bool _byShardValid;                   ///< Whether `_byShard` matches the members.
+
+    std::string _names;                   ///< Rendered NAMES list, valid if `_namesValid`.
+    bool _namesValid;                     ///< Whether `_names` matches the members.
 };
 
 #endif  // CHANNEL_HPP
@@ -1,7 +1,23 @@
 #ifndef CLIENT_HPP
 #define CLIENT_HPP
+#include "InputBuffer.hpp"
+#include "OutputQueue.hpp"
+#include "TimerWheel.hpp"
+#include <memory>
+#include <set>
 #include <string>
 
+/**
+ * @brief Handle of a client (0 is never a valid handle).
+ *
+ * The low 32 bits are the client's file descriptor, the high 32 bits the
+ * generation of that descriptor's slot in the `ClientTable`. The kernel reuses
+ * descriptors at once, but each new connection on a descriptor gets a new
+ * generation, so a handle kept after its client left never refers to the next
+ * connection on the same descriptor.
+ */
+typedef uint64_t ClientId;
+
 /**
  * @brief Enum representing the authentication state of a client.
  *
@@ -25,6 +41,12 @@ enum AuthState
  * - Host information
  * - Input/output buffers for handling messages
  * - Authentication state
+ * - The channels it has joined
+ *
+ * Fields touched for every message (state, flags, timers, buffers, the fd and
+ * nickname) are stored inline. Fields only read by a few commands (username,
+ * host, real name) live in a separately allocated `Profile`, so they do not
+ * take up room in the hot part of the object.
  */
 class Client
 {
@@ -33,8 +55,10 @@ public:
      * @brief Constructs a Client object with the given file descriptor.
      *
      * @param fd The file descriptor of the client's socket.
+     * @param shard Index of the event-loop thread that owns the socket.
+     * @param id The client's handle (see `ClientTable::add()`).
      */
-    Client(int fd);
+    Client(int fd, unsigned int shard = 0, ClientId id = 0);
 
     /** @brief Destructor for the Client class. */
     ~Client();
@@ -42,8 +66,14 @@ public:
     /** @brief Retrieves the client's socket file descriptor. */
     int getFd() const;
 
+    /** @brief Retrieves the client's handle. */
+    ClientId getId() const;
+
+    /** @brief Retrieves the index of the event-loop thread that owns the client. */
+    unsigned int getShard() const;
+
     /** @brief Retrieves the client's current nickname. */
-    std::string getNickname() const;
+    const std::string& getNickname() const;
 
     /** @brief Sets a new nickname for the client. */
     void setNickname(const std::string& newNickname);
@@ -60,22 +90,50 @@ public:
     /** @brief Sets the client's host address. */
     void setHost(const std::string& newHost);
 
+    /** @brief Retrieves the peer's IPv4 address (network byte order). */
+    uint32_t getIp() const;
+
+    /** @brief Records the peer's IPv4 address (network byte order). */
+    void setIp(uint32_t ip);
+
     /** @brief Retrieves the client's real name. */
     std::string getRealName() const;
 
     /** @brief Sets the client's real name. */
     void setRealName(const std::string& realName);
 
-    std::string outBuffer;   ///< Buffer storing unsent outgoing messages.
-    std::string buffer;      ///< Buffer for storing incoming messages.
     AuthState   authState;   ///< Current authentication state of the client.
+    bool        awaitingPong; ///< Whether a keepalive PING is still unanswered.
+    bool        flushQueued;  ///< Whether the owning shard will flush `outBuffer` this pass.
+    bool        writeWatched; ///< Whether the event loop watches the socket for `IO_WRITE`.
+    bool        readPending;  ///< Whether unread input waits for the shard's next pass.
+    uint64_t    lastActivity; ///< Time of the last data received (monotonic ms).
+    TimerId     registrationTimer; ///< Pending registration timeout.
+    TimerId     keepaliveTimer;    ///< Pending keepalive check.
+    OutputQueue outBuffer;   ///< Queue of unsent outgoing messages.
+    InputBuffer buffer;      ///< Buffer for storing incoming messages.
+    std::set<std::string> channels; ///< Channels the client has joined (kept by `Server::joinChannel()`/`leaveChannel()`).
+    uint64_t    notifyEpoch;  ///< Last `Server::notifyChannelPeers()` pass that reached the client.
+    uint64_t    mailEpoch;    ///< Last deduplicated channel mail queued for the client (owning shard only).
 
 private:
+    Client(const Client&);
+    Client& operator=(const Client&);
+
+    /** @brief Rarely read registration details. */
+    struct Profile
+    {
+        std::string username;  ///< Client's username.
+        std::string host;      ///< Client's host address.
+        std::string realName;  ///< Client's real name (set via USER command).
+    };
+
     int         _fd;        ///< File descriptor for the client socket.
+    ClientId    _id;        ///< Handle stored wherever state refers to the client.
+    unsigned int _shard;    ///< Owning event-loop thread (only it touches the socket and buffers).
+    uint32_t    _ip;        ///< Peer address, counted against the per-IP connection limit.
     std::string _nickname;  ///< Client's nickname.
-    std::string _username;  ///< Client's username.
-    std::string _host;      ///< Client's host address.
-    std::string _realName;  ///< Client's real name (set via USER command).
+    std::unique_ptr<Profile> _profile; ///< Cold fields, see the class notes.
 };
 
 #endif  // CLIENT_HPP
@@ -0,0 +1,99 @@
+#ifndef CLIENTTABLE_HPP
+#define CLIENTTABLE_HPP
+#include "Client.hpp"
+#include <memory>
+#include <optional>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @brief The server's clients, stored in a slab indexed by file descriptor.
+ *
+ * Descriptors are small and reused by the kernel, so they index the table
+ * directly:
+ * - `operator[]` is one bounds check and one load from `_byFd`, and never
+ *   inserts anything (unknown descriptors give `NULL`).
+ * - Clients live in fixed-size pages of slots, one slot per descriptor. A page
+ *   is allocated the first time one of its descriptors connects and is kept
+ *   for reuse, so clients neither move nor cost a heap allocation each.
+ * - `fds()` lists the connected descriptors densely, for whole-server walks.
+ * - Each slot has a generation, bumped whenever a client is added to it, which
+ *   makes up the client's `ClientId`. `find()` checks a handle in O(1), so
+ *   state holding handles of departed clients can be cleaned up lazily.
+ *
+ * Not thread-safe: the server guards it with its state mutex.
+ */
+class ClientTable
+{
+public:
+    ClientTable();
+    ~ClientTable();
+
+    /** @brief Returns the client on `fd`, or `NULL` if there is none. */
+    Client* operator[](int fd) const
+    {
+        return static_cast<size_t>(fd) < _byFd.size() ? _byFd[fd] : NULL;
+    }
+
+    /** @brief Returns the client a handle refers to, or `NULL` if it has left. */
+    Client* find(ClientId id) const
+    {
+        size_t fd = static_cast<uint32_t>(id);
+        return fd < _byFd.size() && _generations[fd] == (id >> 32) ? _byFd[fd] : NULL;
+    }
+
+    /** @brief Returns the descriptor part of a handle. */
+    static int fdOf(ClientId id) { return static_cast<int>(static_cast<uint32_t>(id)); }
+
+    /**
+     * @brief Returns the shard owning the client on `fd` (or that owned the last one).
+     *
+     * Read from a dense array, so grouping many handles by shard does not
+     * touch the clients themselves.
+     */
+    unsigned int shardOf(int fd) const
+    {
+        return static_cast<size_t>(fd) < _shardByFd.size() ? _shardByFd[fd] : 0;
+    }
+
+    /**
+     * @brief Creates the client for a newly accepted descriptor.
+     *
+     * @param fd The client's socket (must not be in the table).
+     * @param shard Index of the event-loop thread that owns the socket.
+     * @return The new client, which stays at the same address until removed.
+     */
+    Client& add(int fd, unsigned int shard);
+
+    /** @brief Destroys the client on `fd`, if any. */
+    void remove(int fd);
+
+    /** @brief Returns the descriptors of all clients, in no particular order. */
+    const std::vector<int>& fds() const { return _fds; }
+
+    /** @brief Returns the number of clients. */
+    size_t size() const { return _fds.size(); }
+
+private:
+    ClientTable(const ClientTable&);
+    ClientTable& operator=(const ClientTable&);
+
+    static const size_t PAGE_SHIFT = 6; ///< 64 slots per page.
+    static const size_t PAGE_SIZE = size_t(1) << PAGE_SHIFT;
+
+    /** @brief Storage for `PAGE_SIZE` consecutive descriptors. */
+    struct Page
+    {
+        std::optional<Client> slots[PAGE_SIZE];
+    };
+
+    std::vector<Client*> _byFd; ///< fd -> client, `NULL` for free descriptors.
+    std::vector<uint32_t> _generations; ///< fd -> generation of the slot's current (or last) client.
+    std::vector<unsigned int> _shardByFd; ///< fd -> owning shard of the slot's current (or last) client.
+    std::vector<std::unique_ptr<Page>> _pages; ///< Slot storage, by `fd >> PAGE_SHIFT`.
+    std::vector<int> _fds; ///< Connected descriptors, dense.
+    std::vector<size_t> _fdPosition; ///< fd -> its position in `_fds`.
+};
+
+#endif // CLIENTTABLE_HPP
@@ -0,0 +1,38 @@
+#ifndef COMMANDTABLE_HPP
+#define COMMANDTABLE_HPP
+#include "Client.hpp"
+#include "IrcMessage.hpp"
+#include <stddef.h>
+#include <string_view>
+
+class Server;
+
+/** @brief Signature shared by every command handler. */
+typedef void (*CommandHandler)(Server* server, int fd, const IrcMessage& msg);
+
+/**
+ * @brief How the server dispatches one command.
+ *
+ * `Server::processCommand()` enforces `minState` and `minParams` before
+ * calling `handler`, so handlers do not repeat those checks.
+ */
+struct CommandSpec
+{
+    const char* name; ///< The verb in upper case, at most 8 characters.
+    CommandHandler handler; ///< Runs once the checks below have passed.
+    AuthState minState; ///< Least registration progress required (PASS counts as done without a server password).
+    size_t minParams; ///< Fewer parameters are answered with 461.
+};
+
+/**
+ * @brief Looks up the command for a verb, ignoring case.
+ *
+ * The verb is packed into a 64-bit key and looked up in a perfect hash table
+ * built at compile time: one multiply, one shift and one comparison.
+ *
+ * @param verb The verb as received.
+ * @return The command, or `NULL` for an unknown verb.
+ */
+const CommandSpec* findCommand(std::string_view verb);
+
+#endif // COMMANDTABLE_HPP
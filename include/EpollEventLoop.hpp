@@ -0,0 +1,40 @@
+#ifndef EPOLLEVENTLOOP_HPP
+#define EPOLLEVENTLOOP_HPP
+#ifdef __linux__
+#include "EventLoop.hpp"
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <vector>
+
+/**
+ * @brief Linux `epoll` event loop.
+ *
+ * Only descriptors that actually became ready are returned by `wait()`, so the
+ * cost of a wakeup no longer depends on the number of idle connections.
+ * Descriptors registered as edge-triggered are reported once per readiness
+ * transition; re-arming happens implicitly on `modifyFd()`.
+ */
+class EpollEventLoop : public EventLoop
+{
+public:
+    /** @throws std::runtime_error if the epoll instance cannot be created. */
+    EpollEventLoop();
+    ~EpollEventLoop();
+
+    const char* getName() const;
+    void addFd(int fd, unsigned int events, bool edgeTriggered);
+    void modifyFd(int fd, unsigned int events);
+    void removeFd(int fd);
+    int wait(std::vector<IoEvent>& ready, int timeoutMs);
+
+private:
+    /** @brief Converts `IoEventFlags` (plus the ET bit) to an epoll mask. */
+    static uint32_t toEpoll(unsigned int events, bool edgeTriggered);
+
+    int _epollFd;                             ///< The epoll instance.
+    std::vector<struct epoll_event> _events;  ///< Buffer for `epoll_wait()`.
+    std::vector<unsigned char> _edgeTriggered; ///< Per-fd ET flag, indexed by fd.
+};
+
+#endif  // __linux__
+#endif  // EPOLLEVENTLOOP_HPP
@@ -0,0 +1,94 @@
+#ifndef EVENTLOOP_HPP
+#define EVENTLOOP_HPP
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Readiness flags reported by (and requested from) an event loop.
+ *
+ * Hang-ups and socket errors are reported as `IO_READ`, so that the next
+ * `recv()` observes the EOF or the error and the client is cleaned up on the
+ * usual read path.
+ */
+enum IoEventFlags
+{
+    IO_READ  = 1 << 0,  ///< The descriptor is readable (or hung up).
+    IO_WRITE = 1 << 1   ///< The descriptor is writable.
+};
+
+/**
+ * @brief A single readiness notification returned by `EventLoop::wait()`.
+ */
+struct IoEvent
+{
+    int          fd;      ///< The descriptor that became ready.
+    unsigned int events;  ///< Combination of `IoEventFlags`.
+};
+
+/**
+ * @brief Abstract readiness-based event loop (reactor) used by the Server.
+ *
+ * The server registers its listening socket and every client socket with the
+ * loop, declares which readiness it is interested in, and then repeatedly calls
+ * `wait()` to obtain only the descriptors that actually became ready.
+ *
+ * Backends:
+ * - `poll`  : portable fallback built on `poll()` (O(N) per wakeup).
+ * - `epoll` : Linux `epoll` backend (O(ready) per wakeup), edge-triggered for
+ *             client sockets.
+ */
+class EventLoop
+{
+public:
+    virtual ~EventLoop();
+
+    /** @brief Returns the backend name (e.g. "epoll"). */
+    virtual const char* getName() const = 0;
+
+    /**
+     * @brief Starts watching a descriptor.
+     *
+     * @param fd The descriptor to watch.
+     * @param events Combination of `IoEventFlags` to watch for.
+     * @param edgeTriggered `true` to only report transitions to readiness.
+     * An edge-triggered reader must drain the descriptor until `EAGAIN`.
+     * Backends without edge-triggered support ignore this flag.
+     */
+    virtual void addFd(int fd, unsigned int events, bool edgeTriggered) = 0;
+
+    /**
+     * @brief Changes the set of events watched for a registered descriptor.
+     *
+     * @param fd The registered descriptor.
+     * @param events The new combination of `IoEventFlags`.
+     */
+    virtual void modifyFd(int fd, unsigned int events) = 0;
+
+    /**
+     * @brief Stops watching a descriptor. Must be called before `close()`.
+     *
+     * @param fd The registered descriptor.
+     */
+    virtual void removeFd(int fd) = 0;
+
+    /**
+     * @brief Waits for readiness on the registered descriptors.
+     *
+     * @param ready Output vector, cleared and filled with the ready descriptors.
+     * @param timeoutMs Maximum time to block in milliseconds (`-1` = forever).
+     * @return The number of ready descriptors, or `-1` on error (`errno` set).
+     */
+    virtual int wait(std::vector<IoEvent>& ready, int timeoutMs) = 0;
+
+    /**
+     * @brief Creates an event loop for the given backend name.
+     *
+     * @param backend "epoll" or "poll". An empty string selects the default
+     * backend for the platform.
+     * @throws std::runtime_error if the backend is unknown or cannot be created.
+     */
+    static std::unique_ptr<EventLoop> create(const std::string& backend);
+};
+
+#endif  // EVENTLOOP_HPP
@@ -1,5 +1,7 @@
 #ifndef FILETRANSFER_HPP
 #define FILETRANSFER_HPP
+#include "Client.hpp"
+#include "TimerWheel.hpp"
 #include <string>
 #include <vector>
 
@@ -19,25 +21,25 @@ public:
     /**
      * @brief Construct a file transfer object with all needed fields.
      *
-     * @param senderFd   The file descriptor of the sender
-     * @param receiverFd The file descriptor of the receiver
+     * @param sender     The handle of the sender
+     * @param receiver   The handle of the receiver
      * @param filename   The file name
      * @param filesize   The total expected size of the file (in bytes)
      */
-    FileTransfer(int senderFd,
-                 int receiverFd,
+    FileTransfer(ClientId sender,
+                 ClientId receiver,
                  const std::string& filename,
                  size_t filesize);
 
     /**
-     * @brief Returns the sender's file descriptor.
+     * @brief Returns the sender's handle.
      */
-    int getSenderFd() const;
+    ClientId getSender() const;
 
     /**
-     * @brief Returns the receiver's file descriptor.
+     * @brief Returns the receiver's handle (the receiver may have left since).
      */
-    int getReceiverFd() const;
+    ClientId getReceiver() const;
 
     /**
      * @brief Returns the filename (as specified by the sender).
@@ -71,13 +73,24 @@ public:
      */
     const std::vector<char>& getFileBuffer() const;
 
+    /**
+     * @brief Returns the timer that expires the transfer when it goes idle.
+     */
+    TimerId getExpiryTimer() const;
+
+    /**
+     * @brief Records the timer that expires the transfer when it goes idle.
+     */
+    void setExpiryTimer(TimerId id);
+
 private:
-    int _senderFd;         ///< The sender's file descriptor
-    int _receiverFd;       ///< The receiver's file descriptor
+    ClientId _sender;      ///< The sender's handle
+    ClientId _receiver;    ///< The receiver's handle
     std::string _filename; ///< The file name
     size_t _filesize;      ///< The declared file size
     size_t _receivedBytes; ///< How many bytes we've received so far
     std::vector<char> _fileBuffer; ///< The accumulated file data
+    TimerId _expiryTimer;  ///< Idle expiry timer (0 when none)
 };
 
 #endif // FILETRANSFER_HPP
@@ -0,0 +1,88 @@
+#ifndef INPUTBUFFER_HPP
+#define INPUTBUFFER_HPP
+#include <stddef.h>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Growable receive buffer of one client socket.
+ *
+ * Bytes are read straight into the buffer (`prepare()` + `commit()`) and
+ * consumed from the front (`consume()`), which only moves an offset; the
+ * unread remainder is moved to the front only when the free tail is too small
+ * for the next read.
+ *
+ * The buffer also picks how much to ask from each `recv()`: the size doubles
+ * when a read fills it (a bursty sender, e.g. a paste or a FILE upload) and
+ * halves after reads that use a small part of it. Once drained, a buffer that
+ * grew large gives its memory back, so idle clients stay cheap.
+ *
+ * `nextLine()` frames the data into lines without copying: it returns views
+ * into the buffer and remembers how far it scanned, so a partial line is
+ * never searched twice.
+ */
+class InputBuffer
+{
+public:
+    InputBuffer();
+
+    /** @brief Returns the first unconsumed byte. */
+    const char* data() const;
+
+    /** @brief Returns the number of unconsumed bytes. */
+    size_t size() const;
+
+    /** @brief Whether no bytes are waiting to be consumed. */
+    bool empty() const;
+
+    /**
+     * @brief Returns room for at least `length` more bytes after the data.
+     *
+     * May move the data or reallocate, invalidating earlier pointers.
+     */
+    char* prepare(size_t length);
+
+    /** @brief Appends `length` bytes written into the area from `prepare()`. */
+    void commit(size_t length);
+
+    /** @brief Drops `length` bytes from the front. */
+    void consume(size_t length);
+
+    /**
+     * @brief Extracts the next complete line, terminated by "\n" or "\r\n".
+     *
+     * The line is consumed, but the view stays valid until the next call to
+     * `prepare()`, which is the only call that moves the bytes.
+     *
+     * @param line Receives the line, without its terminator.
+     * @return `false` if no complete line has been received yet.
+     */
+    bool nextLine(std::string_view& line);
+
+    /** @brief Returns how many bytes the next `recv()` should ask for. */
+    size_t readSize() const;
+
+    /**
+     * @brief Adapts the read size to the outcome of a `recv()`.
+     *
+     * @param requested The size that was asked for.
+     * @param received The number of bytes actually read.
+     */
+    void adaptReadSize(size_t requested, size_t received);
+
+    /** @brief Releases the storage of a drained buffer that grew large. */
+    void shrink();
+
+private:
+    static const size_t MIN_READ = 2048; ///< Starting and smallest read size.
+    static const size_t MAX_READ = 64 * 1024; ///< Largest read size.
+    static const size_t KEEP_CAPACITY = 16 * 1024; ///< Storage kept by `shrink()`.
+
+    std::vector<char> _storage; ///< Bytes `[_start, _end)` are unconsumed.
+    size_t _start; ///< Offset of the first unconsumed byte.
+    size_t _end; ///< Offset one past the last received byte.
+    size_t _scanned; ///< Bytes after `_start` already known to hold no "\n".
+    size_t _readSize; ///< Current `recv()` size.
+};
+
+#endif // INPUTBUFFER_HPP
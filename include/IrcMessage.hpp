@@ -0,0 +1,50 @@
+#ifndef IRCMESSAGE_HPP
+#define IRCMESSAGE_HPP
+#include <stddef.h>
+#include <string_view>
+
+/**
+ * @brief One IRC message, split into views of the line it was parsed from.
+ *
+ * Grammar (RFC 1459 with IRCv3 message tags):
+ *   [@<tags> ] [:<prefix> ] <command> [<middle> ...] [:<trailing>]
+ *
+ * `parse()` makes a single pass over the line and stores every field as a
+ * `std::string_view` into it, so parsing allocates nothing. The views are
+ * only valid as long as the line they point into.
+ *
+ * The trailing parameter is stored as the last entry of `params`, like any
+ * other parameter; `hasTrailing` tells whether it was introduced by ':' (and
+ * so may contain spaces or be empty).
+ */
+struct IrcMessage
+{
+    static const size_t MAX_PARAMS = 15; ///< RFC 1459 limit, trailing included.
+
+    IrcMessage();
+
+    /**
+     * @brief Parses one line (without its terminator).
+     *
+     * A 15th parameter takes the rest of the line, as if it were trailing.
+     *
+     * @param line The line to parse; it must outlive the message.
+     * @return `false` if the line holds no command.
+     */
+    bool parse(std::string_view line);
+
+    /** @brief Returns parameter `index`, or an empty view if it is missing. */
+    std::string_view param(size_t index) const;
+
+    /** @brief Returns the trailing parameter, or an empty view if there is none. */
+    std::string_view trailing() const;
+
+    std::string_view tags; ///< Message tags, without the leading '@'.
+    std::string_view prefix; ///< Message source, without the leading ':'.
+    std::string_view command; ///< The verb or numeric, as sent.
+    std::string_view params[MAX_PARAMS]; ///< Parameters, trailing last.
+    size_t paramCount; ///< Number of entries used in `params`.
+    bool hasTrailing; ///< Whether the last parameter is a trailing one.
+};
+
+#endif // IRCMESSAGE_HPP
@@ -0,0 +1,70 @@
+#ifndef LISTQUERY_HPP
+#define LISTQUERY_HPP
+#include "Channel.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief A LIST request: its ELIST filters and how far the listing got.
+ *
+ * LIST's first parameter is a comma-separated list of conditions:
+ * - `>N` / `<N`: more / fewer than N members (ELIST U);
+ * - `<mask>`: channel names matching a wildcard mask (ELIST M), any of them;
+ * - `!<mask>`: channel names not matching the mask (ELIST N);
+ * - `T:<mask>`: topics matching a wildcard mask, any of them.
+ * A channel is listed if it meets every kind of condition given.
+ *
+ * Listing the whole server can take many loop passes (see
+ * `Server::startList()`); the query remembers the name of the next channel to
+ * examine, and resumes from it in the ordered channel map, so channels created
+ * or removed in between are neither repeated nor a problem.
+ */
+class ListQuery
+{
+public:
+    /** @brief A query listing every channel, from the start. */
+    ListQuery();
+
+    /**
+     * @brief Parses LIST's first parameter. Malformed conditions are ignored.
+     *
+     * @param filters The comma-separated conditions (may be empty).
+     */
+    explicit ListQuery(std::string_view filters);
+
+    /**
+     * @brief Whether a channel meets the conditions.
+     *
+     * Member counts come straight from the channel's member array, so the
+     * common `>N` filter costs no work per member.
+     */
+    bool matches(const Channel& channel) const;
+
+    /**
+     * @brief Whether the query names its channels exactly (no wildcard, no `!`).
+     *
+     * Such a query is answered by direct lookups (see `getNames()`) instead
+     * of a walk over every channel.
+     */
+    bool isExact() const;
+
+    /** @brief Returns the channel name masks (exact names if `isExact()`). */
+    const std::vector<std::string>& getNames() const { return _names; }
+
+    /** @brief Returns the name of the next channel to examine ("" at the start). */
+    const std::string& getPosition() const { return _position; }
+
+    /** @brief Records where the next batch resumes. */
+    void setPosition(const std::string& name) { _position = name; }
+
+private:
+    long long _above; ///< Listed channels have more than this many members (-1: any).
+    long long _below; ///< ... and fewer than this many (`LLONG_MAX`: any).
+    std::vector<std::string> _names; ///< Name masks, one must match (none: any name).
+    std::vector<std::string> _excludes; ///< Name masks that must not match.
+    std::vector<std::string> _topics; ///< Topic masks, one must match (none: any topic).
+    std::string _position; ///< Next channel to examine, by name.
+};
+
+#endif // LISTQUERY_HPP
@@ -0,0 +1,95 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+#include <sstream>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Severity of a log line.
+ */
+enum LogLevel
+{
+    LOG_LEVEL_DEBUG = 0, ///< Per-command traces, off by default.
+    LOG_LEVEL_INFO = 1,  ///< Connections, disconnections, timeouts.
+    LOG_LEVEL_WARN = 2,  ///< Recoverable problems.
+    LOG_LEVEL_ERROR = 3  ///< Failed system calls and lost clients.
+};
+
+/**
+ * @brief Lowest level compiled in; `-DIRC_LOG_LEVEL=1` strips every `LOG_DEBUG`.
+ */
+#ifndef IRC_LOG_LEVEL
+#define IRC_LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+/**
+ * @brief Asynchronous logger.
+ *
+ * Event-loop threads never touch the terminal: `write()` copies the line into
+ * a fixed-size slot of a lock-free ring buffer (a bounded multi-producer queue
+ * where each slot carries a sequence number) and returns. A background thread
+ * drains the ring, formats the timestamps and writes the lines in batches,
+ * INFO and DEBUG to stdout, WARN and ERROR to stderr. When the ring is full
+ * the line is dropped and counted rather than blocking the caller.
+ *
+ * Timestamps are not computed per line: each loop pass calls `tick()`, which
+ * samples the wall clock once, and the writer only re-formats the date when
+ * the second changes.
+ *
+ * Use the `LOG_*` macros: the message is only formatted when its level is
+ * both compiled in (`IRC_LOG_LEVEL`) and enabled at runtime (`setLevel()`).
+ */
+class Logger
+{
+public:
+    /** @brief Starts the writer thread. */
+    static void start();
+
+    /** @brief Writes every queued line and stops the writer thread. */
+    static void stop();
+
+    /** @brief Sets the lowest level written at runtime (INFO by default). */
+    static void setLevel(LogLevel level);
+
+    /**
+     * @brief Parses a level name ("debug", "info", "warn" or "error").
+     *
+     * @param name The name to parse.
+     * @param level Receives the level.
+     * @return `false` if the name is unknown.
+     */
+    static bool parseLevel(const std::string& name, LogLevel& level);
+
+    /** @brief Whether lines of `level` are written. */
+    static bool enabled(LogLevel level);
+
+    /** @brief Samples the wall clock used to stamp the following lines. */
+    static void tick();
+
+    /**
+     * @brief Queues a line (truncated if longer than a ring slot).
+     *
+     * @param level The severity of the line.
+     * @param text The line, without a trailing newline.
+     */
+    static void write(LogLevel level, std::string_view text);
+
+    /** @brief Returns the calling thread's formatting stream, emptied. */
+    static std::ostringstream& stream();
+};
+
+#define IRC_LOG(level, message)                                               \
+    do {                                                                      \
+        if ((level) >= IRC_LOG_LEVEL && Logger::enabled(level)) {             \
+            std::ostringstream& logStream_ = Logger::stream();                \
+            logStream_ << message;                                            \
+            Logger::write((level), logStream_.str());                         \
+        }                                                                     \
+    } while (0)
+
+#define LOG_DEBUG(message) IRC_LOG(LOG_LEVEL_DEBUG, message)
+#define LOG_INFO(message) IRC_LOG(LOG_LEVEL_INFO, message)
+#define LOG_WARN(message) IRC_LOG(LOG_LEVEL_WARN, message)
+#define LOG_ERROR(message) IRC_LOG(LOG_LEVEL_ERROR, message)
+
+#endif // LOGGER_HPP
@@ -0,0 +1,92 @@
+#ifndef OUTPUTQUEUE_HPP
+#define OUTPUTQUEUE_HPP
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+/**
+ * @brief An immutable, reference-counted message.
+ *
+ * Built once and queued by reference to every recipient (see
+ * `Server::safeSend()`), so fanning a line out to a channel costs one copy of
+ * it, not one per member.
+ */
+typedef std::shared_ptr<const std::string> SharedMessage;
+
+/**
+ * @brief Queue of outgoing bytes for one client socket.
+ *
+ * Data is kept as a chain of reference-counted segments instead of one
+ * contiguous string:
+ * - `writeTo()` hands up to `IOV_BATCH` segments to a single `sendmsg()`
+ *   (scatter-gather), so a long backlog costs one system call per flush.
+ * - Sent bytes are consumed by dropping whole segments and moving an offset
+ *   into the first one; the unsent remainder is never copied or moved.
+ * - A segment can be shared by many queues (the same line sent to every
+ *   member of a channel), in which case it is never copied at all.
+ *
+ * Small private appends are coalesced into the last segment, so a burst of
+ * short replies does not turn into a burst of tiny iovecs.
+ */
+class OutputQueue
+{
+public:
+    OutputQueue();
+
+    /** @brief Whether no bytes are pending. */
+    bool empty() const;
+
+    /** @brief Returns the number of pending bytes. */
+    size_t size() const;
+
+    /**
+     * @brief Queues a copy of `data`, starting at `offset`.
+     *
+     * @param data The bytes to send.
+     * @param offset How many leading bytes of `data` were already sent.
+     */
+    void append(std::string_view data, size_t offset = 0);
+
+    /**
+     * @brief Queues a shared, immutable segment without copying it.
+     *
+     * @param segment The bytes to send (ignored if null or empty).
+     */
+    void append(const SharedMessage& segment);
+
+    /**
+     * @brief Writes as much of the queue as the socket accepts in one `sendmsg()`.
+     *
+     * The socket must be non-blocking. `MSG_NOSIGNAL` is used, so a peer that
+     * went away yields `EPIPE` instead of killing the process.
+     *
+     * @param fd The socket to write to.
+     * @return The number of bytes written and consumed, or `-1` with `errno` set.
+     */
+    ssize_t writeTo(int fd);
+
+    /** @brief Drops every pending byte. */
+    void clear();
+
+private:
+    static const size_t IOV_BATCH = 64; ///< Segments passed to one `sendmsg()`.
+    static const size_t COALESCE_LIMIT = 4096; ///< Private segments grow up to this size.
+
+    /** @brief A slice of bytes still to be sent. */
+    struct Segment
+    {
+        SharedMessage data; ///< The bytes (possibly shared).
+        std::string* owned; ///< Same string when private to this queue, so it can grow; else `NULL`.
+        size_t offset; ///< Bytes of `data` already sent.
+    };
+
+    /** @brief Drops `count` bytes from the front of the queue. */
+    void consume(size_t count);
+
+    std::deque<Segment> _segments; ///< Pending segments, oldest first.
+    size_t _size; ///< Total pending bytes.
+};
+
+#endif // OUTPUTQUEUE_HPP
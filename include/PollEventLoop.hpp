@@ -0,0 +1,37 @@
+#ifndef POLLEVENTLOOP_HPP
+#define POLLEVENTLOOP_HPP
+#include "EventLoop.hpp"
+#include <poll.h>
+#include <vector>
+
+/**
+ * @brief Portable `poll()`-based event loop.
+ *
+ * Keeps one `pollfd` per registered descriptor in a dense vector, plus an
+ * fd-indexed table of slot positions, so that modifying or removing a
+ * descriptor is O(1): removal moves the last entry into the freed slot
+ * (swap-and-pop) instead of shifting the tail of the vector. Every `wait()`
+ * still hands the whole vector to the kernel, but the scan for `revents`
+ * stops as soon as all ready entries have been seen.
+ */
+class PollEventLoop : public EventLoop
+{
+public:
+    PollEventLoop();
+    ~PollEventLoop();
+
+    const char* getName() const;
+    void addFd(int fd, unsigned int events, bool edgeTriggered);
+    void modifyFd(int fd, unsigned int events);
+    void removeFd(int fd);
+    int wait(std::vector<IoEvent>& ready, int timeoutMs);
+
+private:
+    /** @brief Returns the index of `fd` in `_pollFds`, or `-1`. */
+    int findSlot(int fd) const;
+
+    std::vector<struct pollfd> _pollFds; ///< Watched descriptors (dense, unordered).
+    std::vector<int> _slots; ///< Index in `_pollFds` of each fd (`-1` if not watched).
+};
+
+#endif  // POLLEVENTLOOP_HPP
@@ -1,10 +1,156 @@
 #ifndef REPLIES_HPP
 #define REPLIES_HPP
+#include <stddef.h>
 #include <string>
+#include <string_view>
 
+class Channel;
 class Server;
 
+/**
+ * @brief A reply the server sends about itself: its command and default text.
+ *
+ * Numerics are built at compile time by `numeric<Code>()`, which checks the
+ * code and spells it as the three digits sent on the wire.
+ */
+struct Numeric
+{
+    const char* command; ///< Three-digit code (or a verb, e.g. "NOTICE").
+    const char* text; ///< Default trailing text, or `NULL` for none.
+};
+
+/** @brief The three digits of a numeric code, zero-padded, as a static string. */
+template <unsigned int Code>
+struct NumericCode
+{
+    static_assert(Code >= 1 && Code <= 999, "numeric replies have three digits");
+    static constexpr char digits[4] = { char('0' + Code / 100), char('0' + Code / 10 % 10),
+        char('0' + Code % 10), '\0' };
+};
+
+/** @brief Returns the descriptor of numeric `Code`, with its default text. */
+template <unsigned int Code>
+constexpr Numeric numeric(const char* text = NULL)
+{
+    return Numeric { NumericCode<Code>::digits, text };
+}
+
+constexpr Numeric RPL_WELCOME = numeric<1>();
+constexpr Numeric RPL_YOURHOST = numeric<2>();
+constexpr Numeric RPL_CREATED = numeric<3>("This server was created just now");
+constexpr Numeric RPL_MYINFO = numeric<4>();
+constexpr Numeric RPL_ISUPPORT = numeric<5>("are supported by this server");
+constexpr Numeric RPL_WHOISUSER = numeric<311>();
+constexpr Numeric RPL_ENDOFWHO = numeric<315>("End of WHO list");
+constexpr Numeric RPL_ENDOFWHOIS = numeric<318>("End of WHOIS");
+constexpr Numeric RPL_LIST = numeric<322>();
+constexpr Numeric RPL_LISTEND = numeric<323>("End of LIST");
+constexpr Numeric RPL_CHANNELMODEIS = numeric<324>();
+constexpr Numeric RPL_NOTOPIC = numeric<331>("No topic is set");
+constexpr Numeric RPL_TOPIC = numeric<332>();
+constexpr Numeric RPL_INVITING = numeric<341>();
+constexpr Numeric RPL_WHOREPLY = numeric<352>();
+constexpr Numeric RPL_NAMREPLY = numeric<353>();
+constexpr Numeric RPL_ENDOFNAMES = numeric<366>("End of /NAMES list");
+constexpr Numeric ERR_UNKNOWNERROR = numeric<400>();
+constexpr Numeric ERR_NOSUCHNICK = numeric<401>("No such nick/channel");
+constexpr Numeric ERR_NOSUCHCHANNEL = numeric<403>("No such channel");
+constexpr Numeric ERR_TOOMANYTARGETS = numeric<407>("Too many recipients. No message delivered");
+constexpr Numeric ERR_UNKNOWNCOMMAND = numeric<421>("Unknown command");
+constexpr Numeric ERR_NONICKNAMEGIVEN = numeric<431>("No nickname given");
+constexpr Numeric ERR_NICKNAMEINUSE = numeric<433>("Nickname is already in use");
+constexpr Numeric ERR_USERNOTINCHANNEL = numeric<441>("They aren't on that channel");
+constexpr Numeric ERR_NOTONCHANNEL = numeric<442>("You're not on that channel");
+constexpr Numeric ERR_USERONCHANNEL = numeric<443>("is already on channel");
+constexpr Numeric ERR_NOTREGISTERED = numeric<451>("You have not registered");
+constexpr Numeric ERR_NEEDMOREPARAMS = numeric<461>("Not enough parameters");
+constexpr Numeric ERR_ALREADYREGISTRED = numeric<462>("You may not reregister");
+constexpr Numeric ERR_PASSWDMISMATCH = numeric<464>("Password incorrect");
+constexpr Numeric ERR_CHANNELISFULL = numeric<471>("Channel is full");
+constexpr Numeric ERR_UNKNOWNMODE = numeric<472>("is unknown mode char to me");
+constexpr Numeric ERR_INVITEONLYCHAN = numeric<473>("Cannot join channel (+i mode set)");
+constexpr Numeric ERR_BADCHANNELKEY = numeric<475>("Cannot join channel (+k mode set)");
+constexpr Numeric ERR_BADCHANNAME = numeric<479>("Illegal channel name. Channel names must start with '#'");
+constexpr Numeric ERR_CHANOPRIVSNEEDED = numeric<482>("You're not channel operator");
+constexpr Numeric ERR_USERSDONTMATCH = numeric<502>("Cannot change mode for other users");
+
+/** @brief A server NOTICE addressed to the client (`:<server> NOTICE <nick> :<text>`). */
+constexpr Numeric SERVER_NOTICE = { "NOTICE", NULL };
+
+/** @brief A server MODE addressed to the client (`:<server> MODE <nick> ...`). */
+constexpr Numeric SERVER_MODE = { "MODE", NULL };
+
+/**
+ * @brief Formats one reply from the server to a client and queues it.
+ *
+ * Every reply has the same shape:
+ *   :<server> <numeric> <nick> [<param> ...] [:<text>]
+ * The prefix and the recipient's nickname (`*` before it has one) are filled
+ * in by the constructor, so callers only give what is specific to the reply:
+ * @code
+ * Reply(server, fd, ERR_NOSUCHNICK).param(target).send();
+ * Reply(server, fd, RPL_LIST).param(name).param(count).text(topic).send();
+ * @endcode
+ *
+ * The line is formatted into a fixed buffer inside the object (numbers with
+ * `std::to_chars`) and handed to `Server::safeSend()` as a view, which
+ * copies it straight onto the client's output queue: no temporary strings
+ * are built. Lines longer than the protocol's 512 bytes are truncated.
+ */
+class Reply
+{
+public:
+    static const size_t MAX_LINE = 512; ///< RFC 1459 line limit, CRLF included.
+
+    /**
+     * @brief Starts a reply: `:<server> <numeric> <nick>`.
+     *
+     * @param server The server (for its name, and to send the reply).
+     * @param fd The client receiving the reply.
+     * @param numeric What is being replied.
+     */
+    Reply(Server* server, int fd, const Numeric& numeric);
+
+    /** @brief Appends a middle parameter (must be non-empty, without spaces). */
+    Reply& param(std::string_view value);
+
+    /** @brief Appends a number as a middle parameter. */
+    Reply& param(long long value);
+
+    /**
+     * @brief Appends to the trailing text, replacing the numeric's default.
+     *
+     * The first call starts the trailing parameter; no `param()` may follow.
+     */
+    Reply& text(std::string_view value);
+
+    /** @brief Appends a number to the trailing text. */
+    Reply& text(long long value);
+
+    /** @brief Returns how many more bytes fit on the line (before the CRLF). */
+    size_t room() const { return MAX_LINE - 2 - _length; }
+
+    /** @brief Terminates the line (with the default text if none was given) and queues it. */
+    void send();
+
+private:
+    /** @brief Appends raw bytes, dropping what does not fit before the CRLF. */
+    void put(std::string_view bytes);
+
+    /** @brief Appends a number, formatted with `std::to_chars`. */
+    void putNumber(long long value);
+
+    Server* _server; ///< Server sending the reply.
+    int _fd; ///< Recipient.
+    const char* _defaultText; ///< Trailing text used if `text()` is never called.
+    bool _inText; ///< Whether the trailing parameter was started.
+    size_t _length; ///< Bytes used in `_line`.
+    char _line[MAX_LINE]; ///< The line being formatted.
+};
+
 void sendWelcome(Server* server, int fd);
 
+void sendNames(Server* server, int fd, Channel& channel);
+
 
-#endif
\ No newline at end of file
+#endif
@@ -2,13 +2,22 @@
 #define SERVER_HPP
 #include "Channel.hpp"
 #include "Client.hpp"
+#include "ClientTable.hpp"
+#include "EventLoop.hpp"
 #include "FileTransfer.hpp"
+#include "ListQuery.hpp"
+#include "TimerWheel.hpp"
 #include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
-#include <poll.h>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <sys/socket.h>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 /**
@@ -17,8 +26,26 @@
  * The `Server` class manages the core functionality of an IRC server, including:
  * - Managing client connections and handling authentication.
  * - Handling message routing between users and channels.
- * - Running the main event loop using `poll()` for non-blocking I/O.
+ * - Running the event loops (`epoll` or `poll()`) for non-blocking I/O.
  * - Processing commands received from clients.
+ *
+ * Threading model: the server runs one or more *shards*. Each shard is an
+ * event-loop thread with its own `SO_REUSEPORT` listening socket, so the
+ * kernel spreads incoming connections across them. A client belongs to the
+ * shard that accepted it for its whole life:
+ * - Only the owning shard reads from, writes to, or closes the socket, and
+ *   only it touches the client's `buffer` and `outBuffer`.
+ * - Shared state (`_clients`, `_nicknames`, `_channels`, `_fileTransfers` and
+ *   the client registration fields) is guarded by `_stateMutex`, held while a command
+ *   is dispatched.
+ *
+ * Only socket I/O, input framing, output flushing and mailbox delivery run in
+ * parallel. The lock is global, so command handling, timers and LIST batches
+ * of all shards take turns: commands do not scale with the number of shards.
+ *
+ * - All output goes through `safeSend()`. It is queued on the client and
+ *   written once per loop pass; output for a client owned by another shard is
+ *   posted to that shard's mailbox and queued by its thread, in posting order.
  */
 class Server {
 public:
@@ -30,16 +57,20 @@ public:
      *
      * @param port The port number on which the server listens for incoming connections.
      * @param password The connection password required by clients.
+     * @param eventLoop The event loop backend ("epoll", "poll", or "" for the default).
+     * @param threads The number of event-loop threads (shards), at least 1.
      */
-    Server(int port, const std::string& password);
+    Server(int port, const std::string& password, const std::string& eventLoop = "",
+        unsigned int threads = 1);
 
     /** @brief Destructor for the Server class. Cleans up resources. */
     ~Server();
 
     /**
-     * @brief Runs the main server loop.
+     * @brief Runs the server until shutdown is requested.
      *
-     * Starts the event loop, which continuously:
+     * Starts one thread per extra shard and runs the first shard on the
+     * calling thread. Each shard's event loop continuously:
      * - Polls for incoming data and new connections.
      * - Reads messages from clients and processes them.
      * - Sends responses back to clients when necessary.
@@ -49,10 +80,13 @@ public:
     /**
      * @brief Removes a client from the server.
      *
-     * - Closes the client socket.
-     * - Removes the client from the internal client map.
-     * - Removes the client’s poll descriptor.
-     * - Notifies relevant channels of the disconnection.
+     * Must be called with `_stateMutex` held, on the thread of the shard that
+     * owns the client (every caller removes the client it is serving).
+     *
+     * - Stops all further I/O with the client immediately.
+     * - At the end of the loop pass, removes it from its channels and the
+     *   client table, unregisters its descriptor and closes the socket
+     *   (see `closeRemovedClients()`).
      *
      * @param fd The file descriptor of the client to be removed.
      */
@@ -84,11 +118,13 @@ public:
     void setPassword(const std::string& newPassword);
 
     /**
-     * @brief Retrieves the map of all connected clients.
+     * @brief Retrieves the table of all connected clients.
+     *
+     * `getClients()[fd]` is the client on `fd`, or `NULL`.
      *
-     * @return A reference to the internal map of clients.
+     * @return A reference to the internal client table.
      */
-    std::map<int, std::unique_ptr<Client>>& getClients();
+    ClientTable& getClients();
 
     /**
      * @brief Retrieves the map of all channels.
@@ -112,12 +148,166 @@ public:
     const std::string& getServerName() const;
 
     /**
-     * @brief Sends a message to a client, ensuring that it is properly buffered if the socket is not immediately writable.
+     * @brief Finds the client using a nickname, ignoring RFC 1459 case.
+     *
+     * @param nickname The nickname to look up.
+     * @return The client's file descriptor, or -1 if no client uses it.
+     */
+    int findClientByNick(std::string_view nickname) const;
+
+    /**
+     * @brief Gives a client a new nickname, keeping the nickname index in sync.
+     *
+     * @param fd The file descriptor of the client.
+     * @param nickname The new nickname.
+     * @return `false` (and nothing changes) if another client already uses it.
+     */
+    bool setClientNickname(int fd, const std::string& nickname);
+
+    /**
+     * @brief Adds a client to a channel and records the channel on the client.
+     *
+     * A pending invitation to the channel is used up.
+     *
+     * @param fd The file descriptor of the client.
+     * @param channel The channel to join.
+     */
+    void joinChannel(int fd, Channel& channel);
+
+    /**
+     * @brief Removes a client from a channel, deleting the channel once it is empty.
+     *
+     * References to the channel must not be used afterwards.
      *
      * @param fd The file descriptor of the client.
+     * @param channelName The name of the channel to leave, by value: callers
+     * often pass the client's own entry, or the channel's name, both freed here.
+     */
+    void leaveChannel(int fd, std::string channelName);
+
+    /**
+     * @brief Invites a client to a channel.
+     *
+     * @param fd The file descriptor of the invited client.
+     * @param channel The channel the client is invited to.
+     */
+    void inviteToChannel(int fd, Channel& channel);
+
+    /**
+     * @brief Queues a message for a client; it is written at the end of the owner's loop pass.
+     *
+     * Called from command handlers (with `_stateMutex` held). Messages for a
+     * client owned by another shard are handed to that shard's mailbox.
+     *
+     * @param fd The file descriptor of the client.
+     * @param message The message to be sent.
+     */
+    void safeSend(int fd, std::string_view message);
+
+    /**
+     * @brief Queues a shared message for a client, by reference (see `SharedMessage`).
+     *
+     * Use it to send one line to many clients: build it once, then pass the
+     * same `SharedMessage` for every recipient.
+     *
+     * @param fd The file descriptor of the client.
+     * @param message The message to be sent.
+     */
+    void safeSend(int fd, const SharedMessage& message);
+
+    /**
+     * @brief Queues a message for a client given by handle (see `safeSend()`).
+     *
+     * Does nothing if the client has left the server.
+     *
+     * @param id The handle of the client.
+     * @param message The message to be sent.
+     */
+    void sendTo(ClientId id, const std::string& message);
+
+    /** @brief Queues a shared message for a client given by handle, by reference. */
+    void sendTo(ClientId id, const SharedMessage& message);
+
+    /**
+     * @brief Sends a message to every member of a channel.
+     *
+     * Small channels are served on the calling thread. A channel with at least
+     * `setFanoutThreshold()` members is handed to the shards instead: each one
+     * receives the list of the members it owns and queues the message for
+     * them, in parallel, so the calling loop only posts one mail per shard.
+     * Either way, each member receives the message in order with everything
+     * else sent to it.
+     *
+     * @param channel The channel.
+     * @param message The message to be sent.
+     * @param except A member who does not receive it (0 for none).
+     */
+    void sendToChannel(Channel& channel, const SharedMessage& message, ClientId except = 0);
+
+    /**
+     * @brief Sends a message once to every client sharing a channel with `fd`.
+     *
+     * For notifications about the client itself (NICK, QUIT, ...). A peer on
+     * several of the client's channels still gets the message once, and the
+     * client itself never does. Channels past the fan-out threshold are
+     * handed to the shards, as in `sendToChannel()`.
+     *
+     * @param fd The file descriptor of the client the notification is about.
+     * @param message The message to be sent.
+     */
+    void notifyChannelPeers(int fd, const SharedMessage& message);
+
+    /**
+     * @brief Starts a deduplicated delivery: each client receives at most one `sendOnce()` of it.
+     *
+     * @return The epoch to pass to `sendOnce()`.
+     */
+    uint64_t newNotifyEpoch();
+
+    /**
+     * @brief Sends a message to a client unless it was already reached in `epoch`.
+     *
+     * @param id The handle of the client.
      * @param message The message to be sent.
+     * @param epoch The delivery, from `newNotifyEpoch()`.
+     * @return `true` if the message was queued.
      */
-    void safeSend(int fd, const std::string& message);
+    bool sendOnce(ClientId id, const SharedMessage& message, uint64_t epoch);
+
+    /**
+     * @brief Hands a channel's part of a deduplicated delivery to the shards, if it is big enough.
+     *
+     * Channels past the fan-out threshold are posted as in `sendToChannel()`;
+     * a client reached through several of them under `epoch` gets the first
+     * one only. Their members must not also be sent the delivery through
+     * `sendOnce()`: callers skip those for whom `hasClient()` holds on one of
+     * the spread channels.
+     *
+     * @param channel The channel.
+     * @param message The message to be sent.
+     * @param except A member who does not receive it (0 for none).
+     * @param epoch The delivery, from `newNotifyEpoch()`.
+     * @return `true` if the channel was handed to the shards, `false` if the
+     * caller must deliver to its members itself.
+     */
+    bool spreadOnce(Channel& channel, const SharedMessage& message, ClientId except, uint64_t epoch);
+
+    /**
+     * @brief Starts streaming the channel list to a client (LIST).
+     *
+     * The channels matching `query` are sent as 322 replies, then a 323. A
+     * large server is listed over several loop passes: each pass examines a
+     * bounded number of channels, and only while the client's output queue
+     * is short, so the listing follows the pace at which the client reads
+     * and never holds up the loop. A new LIST ends one in progress (with
+     * its 323) and replaces it.
+     *
+     * Called from the LIST handler, on the client's own shard.
+     *
+     * @param fd The file descriptor of the client.
+     * @param query The filters, positioned at the start.
+     */
+    void startList(int fd, const ListQuery& query);
 
     /**
      * @brief Sends an error message indicating that a password is required.
@@ -140,48 +330,297 @@ public:
      */
     void notRegistered(int fd);
 
+    /**
+     * @brief Schedules a callback on the calling event-loop thread's timer wheel.
+     *
+     * The callback runs on the same thread, with the shared server state locked,
+     * once `delayMs` milliseconds have passed.
+     *
+     * @param delayMs Delay in milliseconds.
+     * @param callback The action to run.
+     * @return A handle for `cancelTimer()`.
+     */
+    TimerId scheduleTimer(uint64_t delayMs, const std::function<void()>& callback);
+
+    /**
+     * @brief Cancels a timer scheduled by the calling event-loop thread.
+     *
+     * @param id The handle returned by `scheduleTimer()` (stale handles are ignored).
+     */
+    void cancelTimer(TimerId id);
+
+    /**
+     * @brief Sets how many simultaneous connections one IP address may hold.
+     *
+     * Must be called before `run()`.
+     *
+     * @param limit The maximum per address, or 0 for no limit.
+     */
+    void setMaxConnectionsPerIp(unsigned int limit);
+
+    /**
+     * @brief Sets from how many members a channel delivery is spread over all shards.
+     *
+     * Only used when the server runs several shards. Must be called before `run()`.
+     *
+     * @param members The threshold, or 0 to always deliver on the calling thread.
+     */
+    void setFanoutThreshold(size_t members);
+
+    /**
+     * @brief Sets how many comma-separated targets one PRIVMSG or NOTICE may name.
+     *
+     * Must be called before `run()`.
+     *
+     * @param targets The limit (at least 1).
+     */
+    void setMaxTargets(unsigned int targets);
+
+    /** @brief Retrieves the per-message target limit (advertised as `MAXTARGETS`). */
+    unsigned int getMaxTargets() const;
+
+    /**
+     * @brief Asks every event loop to stop. Safe to call from a signal handler.
+     */
     static void requestShutdown();
 
 private:
+    /**
+     * @brief A message posted to a shard's mailbox.
+     *
+     * Either for one client, or a channel delivery: each shard gets the list
+     * of the channel members it owns and queues the message for them.
+     */
+    struct Mail
+    {
+        /** @brief Mail for one client. */
+        Mail(int recipient, const SharedMessage& line);
+
+        /** @brief Mail for the channel members owned by the receiving shard, but `skip`. */
+        Mail(const MemberList& owned, const SharedMessage& line, ClientId skip, uint64_t delivery = 0);
+
+        int fd; ///< Recipient of single-client mail.
+        SharedMessage message; ///< The line to queue.
+        MemberList members; ///< Channel delivery recipients (null for single-client mail).
+        ClientId except; ///< Member a channel delivery skips (0 for none).
+        uint64_t epoch; ///< Delivery whose recipients get one copy (see `Client::mailEpoch`), 0 for none.
+    };
+
+    /**
+     * @brief One event-loop thread and the clients it owns.
+     */
+    struct Shard
+    {
+        explicit Shard(unsigned int shardIndex);
+
+        unsigned int index; ///< Position in `_shards`.
+        int listenFd; ///< This shard's `SO_REUSEPORT` listening socket.
+        int spareFd; ///< Descriptor held in reserve, released to shed connections on `EMFILE`.
+        std::unique_ptr<EventLoop> eventLoop; ///< Readiness backend for the shard's sockets.
+        std::vector<IoEvent> readyEvents; ///< Events returned by the last `wait()`.
+        std::vector<Client*> clients; ///< Owned clients indexed by fd (`NULL` when not owned).
+        int wakeFds[2]; ///< Self-pipe that wakes the loop when mail arrives.
+        std::mutex mailboxMutex; ///< Guards `mailbox` and `hasMail`.
+        std::vector<Mail> mailbox; ///< Messages posted by other shards (or by this one, see `sendToChannel()`).
+        bool hasMail; ///< Whether a wake-up is already pending.
+        TimerWheel timers; ///< Timeouts of the shard's clients and transfers.
+        std::vector<int> pendingFlush; ///< Clients with output queued during this pass.
+        std::vector<int> pendingRead; ///< Clients that used their read budget with data left.
+        std::vector<int> closing; ///< Clients removed during this pass, closed at its end.
+        std::map<int, ListQuery> listings; ///< LIST replies in progress, by client fd (see `startList()`).
+        uint64_t nowMs; ///< Monotonic time, sampled once per loop pass.
+        std::thread thread; ///< The loop thread (shard 0 runs on the caller of `run()`).
+    };
+
     int _port; ///< The port number on which the server listens.
-    int _listen_fd; ///< The listening socket file descriptor.
 
-    std::vector<struct pollfd> _poll_fds; ///< List of poll descriptors (server + clients).
+    std::vector<std::unique_ptr<Shard>> _shards; ///< Event-loop threads.
+    static thread_local Shard* s_currentShard; ///< The shard running on this thread.
+
+    /**
+     * @brief Guards all state shared between shards.
+     *
+     * Held around every command, timer callback, LIST batch and batch of
+     * closes, so that work is serialized across shards (see the class notes).
+     * Recursive because socket errors can remove a client both from the I/O
+     * path and from inside a command handler that already holds it.
+     */
+    std::recursive_mutex _stateMutex;
 
     std::string _password; ///< Server connection password.
 
-    std::map<int, std::unique_ptr<Client>> _clients; ///< Active clients.
+    ClientTable _clients; ///< Active clients, indexed by fd.
+    std::unordered_map<std::string, int> _nicknames; ///< Casefolded nickname -> fd of its client.
     std::map<std::string, Channel> _channels; ///< Active channels.
+    uint64_t _notifyEpoch; ///< Last pass of `notifyChannelPeers()` (stamped on the clients it reached).
     std::map<std::string, FileTransfer> _fileTransfers; ///< Ongoing file transfers.
+    std::map<uint32_t, unsigned int> _connectionsPerIp; ///< Open connections by peer address.
+    unsigned int _maxConnectionsPerIp; ///< Per-address limit (0 for none).
+    size_t _fanoutThreshold; ///< Channel size handed to all shards for delivery (0 for never).
+    unsigned int _maxTargets; ///< Targets allowed in one PRIVMSG or NOTICE.
 
     std::string _serverName; ///< The name of the IRC server.
 
     /**
-     * @brief Sets up the server's listening socket.
+     * @brief Sets up a shard's listening socket.
      *
-     * - Creates a non-blocking socket.
+     * - Creates a non-blocking socket (with `SO_REUSEPORT` when sharded).
      * - Binds the socket to the specified port.
      * - Begins listening for incoming connections.
      *
+     * @param shard The shard that will own the socket.
      * @throws std::runtime_error if any socket operations fail.
      */
-    void setupServer();
+    void setupServer(Shard& shard);
+
+    /**
+     * @brief Runs the event loop of one shard until shutdown is requested.
+     *
+     * @param shard The shard to run on the calling thread.
+     */
+    void runShard(Shard& shard);
+
+    /**
+     * @brief Accepts the connections waiting on a shard's listening socket.
+     *
+     * - Accepts up to a fixed budget of connections per call with `accept4()`,
+     *   which returns them already non-blocking and close-on-exec.
+     * - Sheds connections with the spare descriptor when out of descriptors.
+     * - Refuses peers that already hold their per-IP share of connections.
+     * - Adds the other clients to the list of tracked connections.
+     *
+     * @param shard The shard accepting (and owning) the connections.
+     */
+    void acceptNewConnection(Shard& shard);
+
+    /**
+     * @brief Accepts one pending connection and closes it at once.
+     *
+     * Used when the process is out of descriptors: the spare descriptor is
+     * released to make room, so the backlog drains instead of keeping the
+     * listening socket ready forever.
+     *
+     * @param shard The accepting shard.
+     * @return `true` if a connection was shed.
+     */
+    bool shedConnection(Shard& shard);
+
+    /**
+     * @brief Returns the client owned by `shard` on `fd`, or `NULL`.
+     */
+    static Client* ownedClient(const Shard& shard, int fd);
+
+    /**
+     * @brief Queues a message for a client owned by the calling shard.
+     *
+     * @param shard The calling shard, which owns `fd`.
+     * @param fd The file descriptor of the client.
+     * @param message The message to be sent.
+     */
+    void queueOwned(Shard& shard, int fd, std::string_view message);
+
+    /** @brief Queues a shared message for a client owned by the calling shard, by reference. */
+    void queueOwned(Shard& shard, int fd, const SharedMessage& message);
+
+    /** @brief Puts a client with new output on the shard's flush list, once per pass. */
+    void scheduleFlush(Shard& shard, Client* client);
+
+    /**
+     * @brief Flushes every client that had output queued during the current pass.
+     *
+     * @param shard The calling shard.
+     */
+    void flushPendingOutput(Shard& shard);
+
+    /**
+     * @brief Sends the next batch of a client's LIST reply.
+     *
+     * @param shard The calling shard, which owns `fd`.
+     * @param fd The file descriptor of the client.
+     * @param query The listing, moved forward past the channels examined.
+     * @return `true` once the listing is complete (323 sent) or the client is gone.
+     */
+    bool continueList(Shard& shard, int fd, ListQuery& query);
+
+    /** @brief Moves every LIST in progress on the shard forward by one batch. */
+    void serveListings(Shard& shard);
+
+    /** @brief Whether a LIST in progress on the shard can send more right now. */
+    bool hasListingToServe(const Shard& shard) const;
+
+    /**
+     * @brief Queues mail for another shard (or the calling one) and wakes it.
+     *
+     * @param shard The receiving shard.
+     * @param mail The message and its recipients.
+     */
+    void postToShard(Shard& shard, const Mail& mail);
+
+    /**
+     * @brief Delivers every message posted to the calling shard's mailbox.
+     *
+     * @param shard The calling shard.
+     */
+    void drainMailbox(Shard& shard);
+
+    /** @brief Whether deliveries to a channel are handed to the shards (see `sendToChannel()`). */
+    bool spreadsOverShards(const Channel& channel) const;
 
     /**
-     * @brief Accepts a new client connection.
+     * @brief Posts a message to every shard owning members of a channel.
      *
-     * - Accepts a connection from the listening socket.
-     * - Sets the client socket to non-blocking mode.
-     * - Adds the client to the list of tracked connections.
+     * @param channel The channel (past the fan-out threshold).
+     * @param message The message to be sent.
+     * @param except A member who does not receive it (0 for none).
+     * @param epoch A deduplicated delivery (see `Mail::epoch`), or 0.
+     */
+    void postToMembers(Channel& channel, const SharedMessage& message, ClientId except, uint64_t epoch);
+
+    /**
+     * @brief Closes every client removed during the current loop pass, as one batch.
+     *
+     * @param shard The calling shard.
+     */
+    void closeRemovedClients(Shard& shard);
+
+    /**
+     * @brief Disconnects a client that has not completed registration in time.
+     *
+     * @param fd The file descriptor of the client.
+     */
+    void checkRegistration(int fd);
+
+    /**
+     * @brief Keepalive timer: pings an idle client, disconnects a silent one.
+     *
+     * Activity is recorded lazily by the read path, so traffic never touches
+     * the timer; when it fires early relative to the last activity it simply
+     * re-arms itself for the rest of the interval.
+     *
+     * @param fd The file descriptor of the client.
+     */
+    void checkKeepalive(int fd);
+
+    /**
+     * @brief Writes as much of a client's `outBuffer` as the socket accepts.
+     *
+     * - Stops on `EAGAIN`, keeping the remainder for the next `IO_WRITE` event.
+     * - Drops write interest once the buffer is empty.
+     * - Removes the client on a fatal socket error.
+     *
+     * Must run on the thread of the shard owning the client.
+     *
+     * @param fd The file descriptor of the client.
      */
-    void acceptNewConnection();
+    void flushClientOutBuffer(int fd);
 
     /**
      * @brief Handles incoming data from a client.
      *
-     * - Reads available data from the client socket.
+     * - Reads available data from the client socket, up to a per-pass budget.
      * - Buffers the data for message processing.
-     * - Extracts and processes complete commands from the input buffer.
+     * - Extracts and processes complete commands from the input buffer,
+     *   each one with `_stateMutex` held.
      *
      * @param fd The file descriptor of the client.
      */
@@ -190,14 +629,17 @@ private:
     /**
      * @brief Processes a complete command received from a client.
      *
-     * - Parses the command into tokens.
-     * - Dispatches the command to the appropriate handler function.
+     * - Parses the line into an `IrcMessage` without copying it.
+     * - Looks the verb up in the dispatch table (see `CommandTable.hpp`).
+     * - Checks the command's required registration state and parameter count.
+     * - Dispatches the message to the command's handler.
      *
      * @param fd The file descriptor of the client that sent the command.
-     * @param command The complete command string received.
+     * @param line The complete command line received (without its terminator).
      */
-    void processCommand(int fd, const std::string& command);
+    void processCommand(int fd, std::string_view line);
     static std::atomic_bool s_shutdownRequested;
+    static int s_shutdownWakeFd; ///< Wake-up pipe of the first shard, written by `requestShutdown()`.
 };
 
 #endif // SERVER_HPP
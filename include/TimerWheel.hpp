@@ -0,0 +1,134 @@
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @brief Handle of a scheduled timer (0 is never a valid handle).
+ *
+ * Encodes the timer's slot in the node pool and the slot's generation, so a
+ * handle kept after its timer fired or was cancelled is harmlessly ignored.
+ */
+typedef uint64_t TimerId;
+
+/**
+ * @brief Hierarchical timer wheel driving the server's timeouts.
+ *
+ * Time is divided into ticks (10 ms by default). Timers are hashed into four
+ * levels of 64 slots by how far away they are:
+ * - level 0 holds timers due within 64 ticks, one slot per tick;
+ * - level `n` holds timers due within 64^(n+1) ticks, one slot per 64^n ticks.
+ *
+ * When level 0 wraps around, the matching slot of the next level is cascaded
+ * down. Scheduling and cancelling are O(1) (intrusive lists, no searching),
+ * and per-level occupancy bitmaps let `nextTimeoutMs()` find the next
+ * deadline and `advance()` skip empty ticks without scanning slots. With the
+ * default tick the wheel spans about 46 hours; longer delays take extra laps.
+ *
+ * Callbacks run from `advance()` and may freely schedule or cancel timers,
+ * including their own. A wheel is not thread-safe: each event loop owns one.
+ */
+class TimerWheel
+{
+public:
+    typedef std::function<void()> Callback;
+
+    /**
+     * @brief Creates an empty wheel.
+     *
+     * @param nowMs The current monotonic time in milliseconds (see `now()`).
+     * @param tickMs Resolution of the wheel in milliseconds.
+     */
+    TimerWheel(uint64_t nowMs, unsigned int tickMs = 10);
+
+    /** @brief Returns the monotonic clock in milliseconds. */
+    static uint64_t now();
+
+    /**
+     * @brief Schedules `callback` to run once, `delayMs` after the last `advance()`.
+     *
+     * Timers never fire early; they fire at most one tick late.
+     *
+     * @return A handle for `cancel()`.
+     */
+    TimerId schedule(uint64_t delayMs, const Callback& callback);
+
+    /**
+     * @brief Cancels a pending timer.
+     *
+     * @param id The handle returned by `schedule()`. Stale or zero handles are ignored.
+     * @return `true` if a pending timer was cancelled.
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * @brief Runs every timer that is due at `nowMs`.
+     *
+     * @param nowMs The current monotonic time in milliseconds.
+     */
+    void advance(uint64_t nowMs);
+
+    /**
+     * @brief Returns how long the event loop may sleep.
+     *
+     * @param nowMs The current monotonic time in milliseconds.
+     * @return Milliseconds until the next timer (or cascade) is due, `0` if one
+     * is already due, or `-1` if no timer is pending.
+     */
+    int nextTimeoutMs(uint64_t nowMs) const;
+
+    /** @brief Returns the number of pending timers. */
+    size_t size() const;
+
+private:
+    static const unsigned int LEVELS = 4;
+    static const unsigned int SLOT_BITS = 6;
+    static const unsigned int SLOTS = 1u << SLOT_BITS;
+    static const uint32_t NIL = 0xffffffffu;
+    static const uint32_t EXPIRED_LIST = LEVELS * SLOTS; ///< List of timers being run.
+
+    /** @brief A pooled timer, linked into one slot list at a time. */
+    struct Node
+    {
+        uint64_t expiry;      ///< Due tick.
+        uint32_t prev;        ///< Previous node in the list (`NIL` at the head).
+        uint32_t next;        ///< Next node in the list (`NIL` at the tail).
+        uint32_t list;        ///< List the node is linked into (`NIL` when free).
+        uint32_t generation;  ///< Bumped every time the node is released.
+        Callback callback;    ///< Action to run when the timer fires.
+    };
+
+    /** @brief Links a node into the slot matching its expiry. */
+    void place(uint32_t index);
+
+    /** @brief Appends a node to a list and marks the slot occupied. */
+    void link(uint32_t index, uint32_t list);
+
+    /** @brief Removes a node from its list, clearing the occupancy bit if emptied. */
+    void unlink(uint32_t index);
+
+    /** @brief Returns a node to the free list and invalidates its handle. */
+    void release(uint32_t index);
+
+    /** @brief Re-hashes every timer of a higher-level slot into lower levels. */
+    void cascade(unsigned int level, unsigned int slot);
+
+    /** @brief Processes tick `_tick`: cascades, then runs level 0. */
+    void runTick();
+
+    /** @brief Returns the number of ticks until the next occupied slot, or `-1`. */
+    int64_t ticksUntilNext() const;
+
+    unsigned int _tickMs;                   ///< Milliseconds per tick.
+    uint64_t _nowMs;                        ///< Time of the last `advance()`.
+    uint64_t _tick;                         ///< Next tick to process.
+    size_t _count;                          ///< Number of pending timers.
+    std::vector<Node> _nodes;               ///< Node pool.
+    uint32_t _freeList;                     ///< First free node (`NIL` if none).
+    uint32_t _heads[LEVELS * SLOTS + 1];    ///< Slot lists plus the expired list.
+    uint32_t _tails[LEVELS * SLOTS + 1];    ///< Tails, for FIFO order within a slot.
+    uint64_t _occupied[LEVELS];             ///< One bit per non-empty slot.
+};
+
+#endif  // TIMERWHEEL_HPP
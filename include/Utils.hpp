@@ -1,29 +1,38 @@
 #ifndef UTILS_HPP
 #define UTILS_HPP
-#include <string>  
-#include <vector>
+#include <string>
+#include <string_view>
 
 /**
  * @brief Utility functions for string manipulation and general helper methods.
  *
  * The `Utils` namespace provides common helper functions that are used
- * throughout the project. These include string processing utilities and 
- * timestamp retrieval.
+ * throughout the project, such as nickname casefolding and timestamp retrieval.
  */
 namespace Utils
 {
     /**
-     * @brief Splits a string into a vector of substrings using a specified delimiter.
+     * @brief Folds a nickname or channel name with the RFC 1459 casemapping.
      *
-     * This function iterates over the input string and extracts substrings
-     * separated by the given delimiter. The substrings are stored in a 
-     * vector and returned.
+     * Letters are lowered and `[]\^` become `{}|~`, so two names that IRC
+     * considers equal fold to the same string.
      *
-     * @param str The input string to split.
-     * @param delimiter The character used as the delimiter.
-     * @return std::vector<std::string> A vector containing the resulting substrings.
+     * @param name The name to fold.
+     * @return std::string The folded name, usable as a lookup key.
      */
-    std::vector<std::string> split(const std::string& str, char delimiter);
+    std::string casefold(std::string_view name);
+
+    /**
+     * @brief Matches a name against a wildcard mask, ignoring RFC 1459 case.
+     *
+     * `*` matches any run of characters (including none) and `?` any single
+     * character. Runs in O(mask × name) in the worst case, without allocating.
+     *
+     * @param mask The mask, e.g. `#rust*`.
+     * @param name The name to test.
+     * @return Whether the whole name matches the mask.
+     */
+    bool matchMask(std::string_view mask, std::string_view name);
 
     /**
      * @brief Retrieves the current timestamp as a formatted string.
@@ -1,4 +1,6 @@
 #include "../include/Channel.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib> 
 #include <stdexcept>
 
@@ -13,11 +15,14 @@
  */
 Channel::Channel()
     : _name(""),
+      _operatorCount(0),
       _topic(""),
       _inviteOnly(false),
       _topicRestricted(false),
       _channelKey(""),
-      _userLimit(0)
+      _userLimit(0),
+      _byShardValid(false),
+      _namesValid(false)
 {
     // Initialize mode flags in the _modes map
     _modes['i'] = _inviteOnly;     // Invite-only mode
@@ -40,11 +45,14 @@ Channel::Channel()
  */
 Channel::Channel(const std::string& name)
     : _name(name),
+      _operatorCount(0),
       _topic(""),
       _inviteOnly(false),
       _topicRestricted(false),
       _channelKey(""),
-      _userLimit(0)
+      _userLimit(0),
+      _byShardValid(false),
+      _namesValid(false)
 {
     // Initialize mode flags in the _modes map
     _modes['i'] = _inviteOnly;     // Invite-only mode
@@ -65,64 +73,156 @@ Channel::~Channel()
  *
  * @return The name of the channel.
  */
-std::string Channel::getName() const
+const std::string& Channel::getName() const
 {
     return _name;
 }
 
 
 /**
- * @brief Adds a client to the channel.
- *
- * Checks if the client (by file descriptor) is already a member of the channel.
- * If not, adds the client's file descriptor to the _clients vector.
+ * @brief Hashes a client handle to its home slot in `_index`.
  *
- * @param fd The file descriptor of the client to be added.
+ * Handles of clients connected at the same time differ mostly in their small,
+ * dense descriptor bits, so they are spread with a multiplicative (Fibonacci)
+ * hash before masking.
  */
-void Channel::addClient(int fd)
+static size_t homeSlot(ClientId id, size_t mask)
+{
+    return static_cast<size_t>((id * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+
+size_t Channel::findSlot(ClientId id) const
 {
-    if (!hasClient(fd)) _clients.push_back(fd);
+    size_t mask = _index.size() - 1;
+    size_t slot = homeSlot(id, mask);
+    while (_index[slot] != -1 && _clients[_index[slot]] != id)
+        slot = (slot + 1) & mask;
+    return slot;
 }
 
 
 /**
- * @brief Removes a client from the channel.
+ * @brief Empties an `_index` slot without breaking later probe chains.
  *
- * Iterates over the _clients vector and removes the client with the given file
- * descriptor. removes operator status
+ * Uses backward-shift deletion: every following entry whose home slot lies
+ * at or before the hole (cyclically) is moved into it, so no tombstones are
+ * needed.
  *
- * @param fd The file descriptor of the client to be removed.
+ * @param slot The slot to empty.
  */
-void Channel::removeClient(int fd)
+void Channel::eraseSlot(size_t slot)
 {
-    for (auto it = _clients.begin(); it != _clients.end(); ++it)
+    size_t mask = _index.size() - 1;
+    size_t next = (slot + 1) & mask;
+    while (_index[next] != -1)
     {
-        if (*it == fd)
+        size_t home = homeSlot(_clients[_index[next]], mask);
+        if (((next - home) & mask) >= ((next - slot) & mask))
         {
-            _clients.erase(it);
-            break;
+            _index[slot] = _index[next];
+            slot = next;
         }
+        next = (next + 1) & mask;
     }
-    removeOperator(fd);
+    _index[slot] = -1;
+}
+
+
+void Channel::growIndex()
+{
+    _index.assign(_index.empty() ? 8 : _index.size() * 2, -1);
+    for (size_t i = 0; i < _clients.size(); ++i)
+        _index[findSlot(_clients[i])] = static_cast<int>(i);
 }
 
 
 /**
- * @brief Checks if a client is present in the channel.
+ * @brief Adds a client to the channel.
  *
- * Iterates over the _clients vector to verify if a client with the given file
- * descriptor is a member.
+ * Appends the client to the dense member arrays, with no status bits, and
+ * records its position in `_index`. Does nothing if it is already a member.
+ * A cached NAMES list gets the nickname appended, so a join storm does not
+ * rebuild it once per join.
  *
- * @param fd The file descriptor of the client.
- * @return true if the client is in the channel; false otherwise.
+ * @param id The handle of the client to be added.
+ * @param nick The client's nickname (empty drops the NAMES cache).
  */
-bool Channel::hasClient(int fd) const
+void Channel::addClient(ClientId id, std::string_view nick)
 {
-    for (const auto& client_fd : _clients)
+    if (hasClient(id)) return;
+    if ((_clients.size() + 1) * 4 > _index.size() * 3) growIndex();
+    _index[findSlot(id)] = static_cast<int>(_clients.size());
+    _clients.push_back(id);
+    _memberFlags.push_back(0);
+    _byShardValid = false;
+
+    // The new member is last in `_clients`, so it is also last in the list.
+    if (nick.empty())
+        _namesValid = false;
+    else if (_namesValid)
     {
-        if (client_fd == fd) return true;
+        if (!_names.empty()) _names += ' ';
+        _names += nick;
     }
-    return false;
+}
+
+
+/**
+ * @brief Removes a client from the channel.
+ *
+ * Moves the last member into the removed member's position, so the arrays
+ * stay dense, and drops its operator status with it.
+ *
+ * @param id The handle of the client to be removed.
+ */
+void Channel::removeClient(ClientId id)
+{
+    if (_index.empty()) return;
+    size_t slot = findSlot(id);
+    if (_index[slot] == -1) return;
+
+    size_t pos = _index[slot];
+    if (_memberFlags[pos] & MEMBER_OPERATOR) --_operatorCount;
+    eraseSlot(slot);
+
+    size_t last = _clients.size() - 1;
+    if (pos != last)
+    {
+        _clients[pos] = _clients[last];
+        _memberFlags[pos] = _memberFlags[last];
+        _index[findSlot(_clients[pos])] = static_cast<int>(pos);
+    }
+    _clients.pop_back();
+    _memberFlags.pop_back();
+    _byShardValid = false;
+    _namesValid = false;
+}
+
+
+/**
+ * @brief Checks if a client is present in the channel.
+ *
+ * @param id The handle of the client.
+ * @return true if the client is in the channel; false otherwise.
+ */
+bool Channel::hasClient(ClientId id) const
+{
+    return !_index.empty() && _index[findSlot(id)] != -1;
+}
+
+
+/**
+ * @brief Retrieves the status bits of a member.
+ *
+ * @param id The handle of the client.
+ * @return The member's `MemberFlag` bits, or 0 if it is not a member.
+ */
+unsigned char Channel::getMemberFlags(ClientId id) const
+{
+    if (_index.empty()) return 0;
+    int pos = _index[findSlot(id)];
+    return pos == -1 ? 0 : _memberFlags[pos];
 }
 
 
@@ -144,7 +244,7 @@ void Channel::setTopic(const std::string& topic)
  *
  * @return The current topic of the channel.
  */
-std::string Channel::getTopic() const
+const std::string& Channel::getTopic() const
 {
     return _topic;
 }
@@ -219,12 +319,12 @@ bool Channel::hasMode(char mode) const
 
 
 /**
- * @brief Retrieves the list of client file descriptors in the channel.
+ * @brief Retrieves the list of client handles in the channel.
  *
- * @return A constant reference to the vector containing file descriptors of
+ * @return A constant reference to the vector containing the handles of
  * channel members.
  */
-const std::vector<int>& Channel::getClients() const
+const std::vector<ClientId>& Channel::getClients() const
 {
     return _clients;
 }
@@ -233,84 +333,78 @@ const std::vector<int>& Channel::getClients() const
 /**
  * @brief Adds an operator to the channel.
  *
- * If the specified client is not already an operator, adds its file descriptor
- * to the _operators vector.
+ * Sets `MEMBER_OPERATOR` on the member. Only members can be operators, so
+ * this does nothing if the client is not in the channel.
  *
- * @param fd The file descriptor of the client to be granted operator status.
+ * @param id The handle of the client to be granted operator status.
  */
-void Channel::addOperator(int fd)
+void Channel::addOperator(ClientId id)
 {
-    // If the user is already an operator, do nothing.
-    if (!isOperator(fd)) _operators.push_back(fd);
+    if (_index.empty()) return;
+    int pos = _index[findSlot(id)];
+    if (pos == -1 || (_memberFlags[pos] & MEMBER_OPERATOR)) return;
+    _memberFlags[pos] |= MEMBER_OPERATOR;
+    ++_operatorCount;
+    _namesValid = false;
 }
 
 
 /**
  * @brief Removes an operator from the channel.
  *
- * Searches for the client's file descriptor in the _operators vector and
- * removes it.
+ * Clears `MEMBER_OPERATOR` on the member, if it was set.
  *
- * @param fd The file descriptor of the client whose operator status should be
+ * @param id The handle of the client whose operator status should be
  * removed.
  */
-void Channel::removeOperator(int fd)
+void Channel::removeOperator(ClientId id)
 {
-    for (auto it = _operators.begin(); it != _operators.end(); ++it)
-    {
-        if (*it == fd)
-        {
-            _operators.erase(it);
-            break;
-        }
-    }
+    if (_index.empty()) return;
+    int pos = _index[findSlot(id)];
+    if (pos == -1 || !(_memberFlags[pos] & MEMBER_OPERATOR)) return;
+    _memberFlags[pos] &= ~MEMBER_OPERATOR;
+    --_operatorCount;
+    _namesValid = false;
 }
 
 
 /**
  * @brief Checks if a client is an operator in the channel.
  *
- * Iterates over the _operators vector to determine if the given file descriptor
- * corresponds to an operator.
- *
- * @param fd The file descriptor of the client.
+ * @param id The handle of the client.
  * @return true if the client is an operator; false otherwise.
  */
-bool Channel::isOperator(int fd) const
+bool Channel::isOperator(ClientId id) const
 {
-    for (int op : _operators)
-    {
-        if (op == fd) return true;
-    }
-    return false;
+    return getMemberFlags(id) & MEMBER_OPERATOR;
 }
 
 
 /**
  * @brief Invites a client to the channel.
  *
- * Adds the client's file descriptor to the `_invitedClients` set, allowing them to join
+ * Adds the client's handle to the `_invitedClients` set, allowing them to join
  * the channel even if it is invite-only.
  *
- * @param fd The file descriptor of the client to be invited.
+ * @param id The handle of the client to be invited.
  */
-void Channel::inviteClient(int fd)
+void Channel::inviteClient(ClientId id)
 {
-    _invitedClients.insert(fd);
+    _invitedClients.insert(id);
 }
 
 
 /**
  * @brief Checks if a client has been invited to the channel.
  *
- * Determines whether the given file descriptor exists in the `_invitedClients` set.
+ * Determines whether the given handle exists in the `_invitedClients` set.
  *
- * @param fd The file descriptor of the client.
+ * @param id The handle of the client.
  * @return `true` if the client has been invited; `false` otherwise.
  */
-bool Channel::isInvited(int fd) const
+bool Channel::isInvited(ClientId id) const
 {
-    return _invitedClients.find(fd) != _invitedClients.end();
+    return _invitedClients.find(id) != _invitedClients.end();
 }
 
 
@@ -319,9 +413,57 @@ bool Channel::isInvited(int fd) const
  *
  * If a client was invited but has not yet joined, this function revokes their invitation.
  *
- * @param fd The file descriptor of the client whose invite should be removed.
+ * @param id The handle of the client whose invite should be removed.
+ */
+void Channel::removeInvite(ClientId id)
+{
+    _invitedClients.erase(id);
+}
+
+
+/**
+ * @brief Retrieves the clients invited to the channel.
+ *
+ * Invitations are not withdrawn when a client disconnects; a departed
+ * client's handle can never match a later connection, so the server prunes
+ * them lazily.
+ *
+ * @return A constant reference to the set of invited client handles.
  */
-void Channel::removeInvite(int fd)
+const std::set<ClientId>& Channel::getInvites() const
 {
-    _invitedClients.erase(fd);
-}
\ No newline at end of file
+    return _invitedClients;
+}
+
+
+/**
+ * @brief Stores the members grouped by owning shard.
+ *
+ * @param byShard One list per shard, built by the server from `getClients()`.
+ */
+void Channel::setMembersByShard(std::vector<MemberList> byShard)
+{
+    _byShard.swap(byShard);
+    _byShardValid = true;
+}
+
+
+/**
+ * @brief Stores the rendered NAMES list.
+ *
+ * @param names The list, as described in `getCachedNames()`.
+ */
+void Channel::setCachedNames(std::string names)
+{
+    _names.swap(names);
+    _namesValid = true;
+}
+
+
+/**
+ * @brief Drops the NAMES cache; the next reply rebuilds it.
+ */
+void Channel::invalidateNames()
+{
+    _namesValid = false;
+}
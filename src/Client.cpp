@@ -8,17 +8,31 @@
  * real name, and input/output buffers.
  *
  * @param fd The socket file descriptor associated with the client.
+ * @param shard Index of the event-loop thread that owns the socket.
+ * @param id The client's handle.
  */
-Client::Client(int fd)
-    : outBuffer(""),  ///< Initializes the outgoing message buffer as empty.
-      buffer(""),     ///< Initializes the incoming data buffer as empty.
-      authState(NOT_REGISTERED),  ///< Sets initial authentication state to NOT_REGISTERED.
+Client::Client(int fd, unsigned int shard, ClientId id)
+    : authState(NOT_REGISTERED),  ///< Sets initial authentication state to NOT_REGISTERED.
+      awaitingPong(false),  ///< No keepalive PING sent yet.
+      flushQueued(false),  ///< Nothing queued yet.
+      writeWatched(false),  ///< Watched for input only.
+      readPending(false),  ///< No input left unread.
+      lastActivity(0),  ///< Set by the server when the connection is accepted.
+      registrationTimer(0),  ///< No timers armed yet.
+      keepaliveTimer(0),
+      outBuffer(),    ///< Initializes the outgoing message queue as empty.
+      buffer(),       ///< Initializes the incoming data buffer as empty.
+      channels(),     ///< Not on any channel yet.
+      notifyEpoch(0),  ///< Not reached by any peer notification yet.
+      mailEpoch(0),    ///< Not reached by any channel mail yet.
       _fd(fd),        ///< Assigns the socket file descriptor.
+      _id(id),        ///< Records the client's handle.
+      _shard(shard),  ///< Records the owning event-loop thread.
+      _ip(0),         ///< Set by the server when the connection is accepted.
       _nickname(""),  ///< Initializes the nickname as an empty string.
-      _username(""),  ///< Initializes the username as an empty string.
-      _host("localhost"),  ///< Defaults the host to "localhost".
-      _realName("")   ///< Initializes the real name as an empty string.
+      _profile(new Profile())  ///< Empty username and real name.
 {
+    _profile->host = "localhost";  // Defaults the host to "localhost".
 }
 
 /**
@@ -41,12 +55,32 @@ int Client::getFd() const
     return _fd;
 }
 
+/**
+ * @brief Retrieves the client's handle.
+ *
+ * @return The handle that channels and file transfers store for the client.
+ */
+ClientId Client::getId() const
+{
+    return _id;
+}
+
+/**
+ * @brief Retrieves the index of the event-loop thread that owns the client.
+ *
+ * @return The shard index (0 when the server runs a single loop).
+ */
+unsigned int Client::getShard() const
+{
+    return _shard;
+}
+
 /**
  * @brief Retrieves the client's nickname.
  *
  * @return The current nickname of the client.
  */
-std::string Client::getNickname() const
+const std::string& Client::getNickname() const
 {
     return _nickname;
 }
@@ -70,7 +104,7 @@ void Client::setNickname(const std::string& newNickname)
  */
 std::string Client::getUsername() const
 {
-    return _username;
+    return _profile->username;
 }
 
 /**
@@ -82,7 +116,7 @@ std::string Client::getUsername() const
  */
 void Client::setUsername(const std::string& newUsername)
 {
-    _username = newUsername;
+    _profile->username = newUsername;
 }
 
 /**
@@ -92,7 +126,7 @@ void Client::setUsername(const std::string& newUsername)
  */
 std::string Client::getHost() const
 {
-    return _host;
+    return _profile->host;
 }
 
 /**
@@ -104,7 +138,27 @@ std::string Client::getHost() const
  */
 void Client::setHost(const std::string& newHost)
 {
-    _host = newHost;
+    _profile->host = newHost;
+}
+
+/**
+ * @brief Retrieves the peer's IPv4 address.
+ *
+ * @return The address in network byte order.
+ */
+uint32_t Client::getIp() const
+{
+    return _ip;
+}
+
+/**
+ * @brief Records the peer's IPv4 address.
+ *
+ * @param ip The address in network byte order.
+ */
+void Client::setIp(uint32_t ip)
+{
+    _ip = ip;
 }
 
 /**
@@ -114,7 +168,7 @@ void Client::setHost(const std::string& newHost)
  */
 std::string Client::getRealName() const 
 {
-    return _realName;
+    return _profile->realName;
 }
 
 /**
@@ -126,5 +180,5 @@ std::string Client::getRealName() const
  */
 void Client::setRealName(const std::string& realName) 
 {
-    _realName = realName;
+    _profile->realName = realName;
 }
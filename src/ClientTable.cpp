@@ -0,0 +1,68 @@
+#include "../include/ClientTable.hpp"
+
+ClientTable::ClientTable()
+    : _byFd()
+    , _generations()
+    , _shardByFd()
+    , _pages()
+    , _fds()
+    , _fdPosition()
+{
+}
+
+ClientTable::~ClientTable()
+{
+}
+
+/**
+ * @brief Constructs a client in the slot of its descriptor.
+ *
+ * Grows the fd index (and allocates the slot's page) on demand, and starts a
+ * new generation of the slot (skipping 0, so no handle is ever 0).
+ */
+Client& ClientTable::add(int fd, unsigned int shard)
+{
+    size_t index = static_cast<size_t>(fd);
+    if (index >= _byFd.size()) {
+        _byFd.resize(index + 1, NULL);
+        _generations.resize(index + 1, 0);
+        _shardByFd.resize(index + 1, 0);
+        _fdPosition.resize(index + 1, 0);
+    }
+    size_t page = index >> PAGE_SHIFT;
+    if (page >= _pages.size())
+        _pages.resize(page + 1);
+    if (!_pages[page])
+        _pages[page].reset(new Page());
+
+    std::optional<Client>& slot = _pages[page]->slots[index & (PAGE_SIZE - 1)];
+    if (++_generations[index] == 0)
+        _generations[index] = 1;
+    slot.emplace(fd, shard, (static_cast<ClientId>(_generations[index]) << 32) | index);
+    _byFd[index] = &*slot;
+    _shardByFd[index] = shard;
+    _fdPosition[index] = _fds.size();
+    _fds.push_back(fd);
+    return *slot;
+}
+
+/**
+ * @brief Destroys a client and frees its slot.
+ *
+ * The last descriptor in `_fds` takes the removed one's place, so removal is
+ * O(1).
+ */
+void ClientTable::remove(int fd)
+{
+    if (!(*this)[fd])
+        return;
+    size_t index = static_cast<size_t>(fd);
+    _byFd[index] = NULL;
+    _pages[index >> PAGE_SHIFT]->slots[index & (PAGE_SIZE - 1)].reset();
+
+    size_t position = _fdPosition[index];
+    int last = _fds.back();
+    _fds[position] = last;
+    _fdPosition[last] = position;
+    _fds.pop_back();
+}
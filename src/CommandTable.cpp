@@ -0,0 +1,132 @@
+#include "../include/CommandTable.hpp"
+#include "../commands/BotCommand.hpp"
+#include "../commands/Cap.hpp"
+#include "../commands/FileCommand.hpp"
+#include "../commands/Invite.hpp"
+#include "../commands/Join.hpp"
+#include "../commands/Kick.hpp"
+#include "../commands/List.hpp"
+#include "../commands/Mode.hpp"
+#include "../commands/Names.hpp"
+#include "../commands/Nick.hpp"
+#include "../commands/Part.hpp"
+#include "../commands/Pass.hpp"
+#include "../commands/Ping.hpp"
+#include "../commands/Privmsg.hpp"
+#include "../commands/Quit.hpp"
+#include "../commands/Topic.hpp"
+#include "../commands/User.hpp"
+#include "../commands/Who.hpp"
+#include "../commands/Whois.hpp"
+#include <stdint.h>
+
+// Every command the server understands. NICK and USER need PASS first (when
+// the server has a password); the channel commands need full registration.
+static constexpr CommandSpec COMMANDS[] = {
+    { "PASS", handlePassCommand, NOT_REGISTERED, 1 },
+    { "NICK", handleNickCommand, WAITING_FOR_NICK, 0 },
+    { "USER", handleUserCommand, WAITING_FOR_NICK, 4 },
+    { "JOIN", handleJoinCommand, AUTH_REGISTERED, 1 },
+    { "PRIVMSG", handlePrivmsgCommand, AUTH_REGISTERED, 2 },
+    { "NOTICE", handleNoticeCommand, AUTH_REGISTERED, 0 },
+    { "QUIT", handleQuitCommand, NOT_REGISTERED, 0 },
+    { "PART", handlePartCommand, AUTH_REGISTERED, 1 },
+    { "KICK", handleKickCommand, AUTH_REGISTERED, 2 },
+    { "INVITE", handleInviteCommand, AUTH_REGISTERED, 2 },
+    { "TOPIC", handleTopicCommand, AUTH_REGISTERED, 1 },
+    { "MODE", handleModeCommand, AUTH_REGISTERED, 1 },
+    { "FILE", handleFileCommand, NOT_REGISTERED, 1 },
+    { "BOT", handleBotCommand, NOT_REGISTERED, 1 },
+    { "PING", handlePingCommand, NOT_REGISTERED, 0 },
+    { "PONG", handlePongCommand, NOT_REGISTERED, 0 },
+    { "WHO", handleWhoCommand, NOT_REGISTERED, 0 },
+    { "WHOIS", handleWhoisCommand, NOT_REGISTERED, 1 },
+    { "LIST", handleListCommand, NOT_REGISTERED, 0 },
+    { "NAMES", handleNamesCommand, AUTH_REGISTERED, 0 },
+    { "CAP", handleCapCommand, NOT_REGISTERED, 1 },
+};
+
+static constexpr size_t COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+static constexpr unsigned SLOT_BITS = 7;
+static constexpr size_t SLOT_COUNT = size_t(1) << SLOT_BITS;
+
+/**
+ * @brief Packs a verb, upper-cased, into one integer (0 if empty or longer than 8 bytes).
+ */
+static constexpr uint64_t packVerb(std::string_view verb)
+{
+    if (verb.empty() || verb.size() > 8)
+        return 0;
+    uint64_t key = 0;
+    for (size_t i = 0; i < verb.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(verb[i]);
+        if (c >= 'a' && c <= 'z')
+            c = static_cast<unsigned char>(c - 'a' + 'A');
+        key = (key << 8) | c;
+    }
+    return key;
+}
+
+/** @brief Maps a packed verb to its slot (multiplicative hashing). */
+static constexpr size_t slotOf(uint64_t key, uint64_t multiplier)
+{
+    return static_cast<size_t>((key * multiplier) >> (64 - SLOT_BITS));
+}
+
+/** @brief Whether `multiplier` gives every command a slot of its own. */
+static constexpr bool isPerfect(uint64_t multiplier)
+{
+    bool used[SLOT_COUNT] = {};
+    for (size_t i = 0; i < COMMAND_COUNT; ++i) {
+        size_t slot = slotOf(packVerb(COMMANDS[i].name), multiplier);
+        if (used[slot])
+            return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+/** @brief Searches the odd multiples of the golden ratio for a perfect multiplier (0 if none). */
+static constexpr uint64_t findMultiplier()
+{
+    const uint64_t golden = 0x9E3779B97F4A7C15ULL;
+    uint64_t multiplier = golden;
+    for (int attempt = 0; attempt < 4096; ++attempt, multiplier += 2 * golden) {
+        if (isPerfect(multiplier))
+            return multiplier;
+    }
+    return 0;
+}
+
+static constexpr uint64_t MULTIPLIER = findMultiplier();
+static_assert(MULTIPLIER != 0, "no perfect hash found for the command verbs: raise SLOT_BITS");
+
+/** @brief The hash table: the packed verb and the `COMMANDS` index of each used slot. */
+struct DispatchIndex
+{
+    uint64_t keys[SLOT_COUNT];
+    unsigned char entries[SLOT_COUNT];
+};
+
+static constexpr DispatchIndex buildIndex()
+{
+    DispatchIndex index = {};
+    for (size_t i = 0; i < COMMAND_COUNT; ++i) {
+        uint64_t key = packVerb(COMMANDS[i].name);
+        size_t slot = slotOf(key, MULTIPLIER);
+        index.keys[slot] = key;
+        index.entries[slot] = static_cast<unsigned char>(i);
+    }
+    return index;
+}
+
+static constexpr DispatchIndex INDEX = buildIndex();
+
+const CommandSpec* findCommand(std::string_view verb)
+{
+    uint64_t key = packVerb(verb);
+    size_t slot = slotOf(key, MULTIPLIER);
+    if (key == 0 || INDEX.keys[slot] != key)
+        return NULL;
+    return &COMMANDS[INDEX.entries[slot]];
+}
@@ -0,0 +1,126 @@
+#ifdef __linux__
+#include "../include/EpollEventLoop.hpp"
+#include <stdexcept>
+#include <unistd.h>
+
+/**
+ * @brief Creates the epoll instance.
+ *
+ * @throws std::runtime_error if `epoll_create1()` fails.
+ */
+EpollEventLoop::EpollEventLoop()
+    : _epollFd(epoll_create1(EPOLL_CLOEXEC))
+    , _events(256)
+{
+    if (_epollFd < 0)
+        throw std::runtime_error("epoll_create1 failed");
+}
+
+/**
+ * @brief Closes the epoll instance.
+ */
+EpollEventLoop::~EpollEventLoop()
+{
+    if (_epollFd != -1)
+        close(_epollFd);
+}
+
+const char* EpollEventLoop::getName() const
+{
+    return "epoll";
+}
+
+/**
+ * @brief Builds the epoll interest mask.
+ *
+ * Peer hang-ups (`EPOLLRDHUP`) are always watched so that a half-closed client
+ * is noticed even when no data arrives with the FIN.
+ */
+uint32_t EpollEventLoop::toEpoll(unsigned int events, bool edgeTriggered)
+{
+    uint32_t mask = EPOLLRDHUP;
+    if (events & IO_READ)
+        mask |= EPOLLIN;
+    if (events & IO_WRITE)
+        mask |= EPOLLOUT;
+    if (edgeTriggered)
+        mask |= EPOLLET;
+    return mask;
+}
+
+/**
+ * @brief Registers a descriptor with the epoll instance.
+ *
+ * @throws std::runtime_error if `epoll_ctl()` fails.
+ */
+void EpollEventLoop::addFd(int fd, unsigned int events, bool edgeTriggered)
+{
+    struct epoll_event ev;
+    ev.events = toEpoll(events, edgeTriggered);
+    ev.data.fd = fd;
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        throw std::runtime_error("epoll_ctl ADD failed");
+
+    if (static_cast<size_t>(fd) >= _edgeTriggered.size())
+        _edgeTriggered.resize(fd + 1, 0);
+    _edgeTriggered[fd] = edgeTriggered;
+}
+
+/**
+ * @brief Changes the interest mask, keeping the descriptor's trigger mode.
+ *
+ * With `EPOLLET`, a modification re-arms the descriptor: if it is already
+ * writable when `IO_WRITE` is added, the next `wait()` reports it.
+ */
+void EpollEventLoop::modifyFd(int fd, unsigned int events)
+{
+    bool edge = static_cast<size_t>(fd) < _edgeTriggered.size() && _edgeTriggered[fd];
+
+    struct epoll_event ev;
+    ev.events = toEpoll(events, edge);
+    ev.data.fd = fd;
+    epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+/**
+ * @brief Unregisters a descriptor.
+ */
+void EpollEventLoop::removeFd(int fd)
+{
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+    if (static_cast<size_t>(fd) < _edgeTriggered.size())
+        _edgeTriggered[fd] = 0;
+}
+
+/**
+ * @brief Calls `epoll_wait()` and translates the returned events.
+ *
+ * When the event buffer comes back full, it is doubled so that a busy server
+ * collects more events per system call on the next pass.
+ */
+int EpollEventLoop::wait(std::vector<IoEvent>& ready, int timeoutMs)
+{
+    ready.clear();
+    int count = epoll_wait(_epollFd, _events.data(), static_cast<int>(_events.size()), timeoutMs);
+    if (count <= 0)
+        return count;
+
+    for (int i = 0; i < count; ++i) {
+        uint32_t revents = _events[i].events;
+
+        IoEvent ev;
+        ev.fd = _events[i].data.fd;
+        ev.events = 0;
+        if (revents & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            ev.events |= IO_READ;
+        if (revents & EPOLLOUT)
+            ev.events |= IO_WRITE;
+        ready.push_back(ev);
+    }
+
+    if (static_cast<size_t>(count) == _events.size())
+        _events.resize(_events.size() * 2);
+    return count;
+}
+
+#endif  // __linux__
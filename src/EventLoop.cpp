@@ -0,0 +1,32 @@
+#include "../include/EventLoop.hpp"
+#include "../include/EpollEventLoop.hpp"
+#include "../include/PollEventLoop.hpp"
+#include <stdexcept>
+
+EventLoop::~EventLoop()
+{
+}
+
+/**
+ * @brief Creates the event loop backend selected by name.
+ *
+ * The empty name selects the best backend available on the platform
+ * (`epoll` on Linux, `poll` elsewhere).
+ *
+ * @param backend The backend name ("epoll", "poll" or "").
+ * @return A newly created event loop.
+ * @throws std::runtime_error if the backend is unknown or unavailable.
+ */
+std::unique_ptr<EventLoop> EventLoop::create(const std::string& backend)
+{
+#ifdef __linux__
+    if (backend.empty() || backend == "epoll")
+        return std::unique_ptr<EventLoop>(new EpollEventLoop());
+#else
+    if (backend.empty())
+        return std::unique_ptr<EventLoop>(new PollEventLoop());
+#endif
+    if (backend == "poll")
+        return std::unique_ptr<EventLoop>(new PollEventLoop());
+    throw std::runtime_error("Unknown event loop backend: " + backend);
+}
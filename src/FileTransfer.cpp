@@ -4,15 +4,16 @@
  * @brief Default constructor for FileTransfer.
  *
  * Initializes a file transfer session with default values.
- * The sender and receiver file descriptors are set to -1 (invalid),
+ * The sender and receiver handles are set to 0 (invalid),
  * the filename is empty, and the file size is set to 0.
  */
 FileTransfer::FileTransfer()
-    : _senderFd(-1),      ///< Initializes sender file descriptor as invalid (-1).
-      _receiverFd(-1),    ///< Initializes receiver file descriptor as invalid (-1).
+    : _sender(0),         ///< No sender (0 is never a valid handle).
+      _receiver(0),       ///< No receiver.
       _filename(""),      ///< Initializes an empty filename.
       _filesize(0),       ///< Sets file size to 0 (no file assigned yet).
-      _receivedBytes(0)   ///< Initializes received byte count to 0.
+      _receivedBytes(0),  ///< Initializes received byte count to 0.
+      _expiryTimer(0)     ///< No expiry timer armed yet.
 {
 }
 
@@ -20,41 +21,42 @@ FileTransfer::FileTransfer()
  * @brief Parameterized constructor for FileTransfer.
  *
  * Initializes a file transfer session with the given sender and receiver
- * file descriptors, filename, and expected file size.
+ * handles, filename, and expected file size.
  *
- * @param senderFd The file descriptor of the sender.
- * @param receiverFd The file descriptor of the receiver.
+ * @param sender The handle of the sender.
+ * @param receiver The handle of the receiver.
  * @param filename The name of the file being transferred.
  * @param filesize The total size of the file in bytes.
  */
-FileTransfer::FileTransfer(int senderFd, int receiverFd,
+FileTransfer::FileTransfer(ClientId sender, ClientId receiver,
                            const std::string& filename, size_t filesize)
-    : _senderFd(senderFd),   ///< Assigns the sender file descriptor.
-      _receiverFd(receiverFd), ///< Assigns the receiver file descriptor.
+    : _sender(sender),       ///< Assigns the sender handle.
+      _receiver(receiver),   ///< Assigns the receiver handle.
       _filename(filename),   ///< Stores the filename.
       _filesize(filesize),   ///< Stores the expected file size.
-      _receivedBytes(0)      ///< Initializes received byte count to 0.
+      _receivedBytes(0),     ///< Initializes received byte count to 0.
+      _expiryTimer(0)        ///< No expiry timer armed yet.
 {
 }
 
 /**
- * @brief Retrieves the sender's file descriptor.
+ * @brief Retrieves the sender's handle.
  *
- * @return The file descriptor of the sender.
+ * @return The handle of the sender.
  */
-int FileTransfer::getSenderFd() const
+ClientId FileTransfer::getSender() const
 {
-    return _senderFd;
+    return _sender;
 }
 
 /**
- * @brief Retrieves the receiver's file descriptor.
+ * @brief Retrieves the receiver's handle.
  *
- * @return The file descriptor of the receiver.
+ * @return The handle of the receiver.
  */
-int FileTransfer::getReceiverFd() const
+ClientId FileTransfer::getReceiver() const
 {
-    return _receiverFd;
+    return _receiver;
 }
 
 /**
@@ -124,3 +126,23 @@ const std::vector<char>& FileTransfer::getFileBuffer() const
     return _fileBuffer;
 }
 
+
+/**
+ * @brief Retrieves the idle expiry timer of the transfer.
+ *
+ * @return The timer handle, or 0 if none is armed.
+ */
+TimerId FileTransfer::getExpiryTimer() const
+{
+    return _expiryTimer;
+}
+
+/**
+ * @brief Records the idle expiry timer of the transfer.
+ *
+ * @param id The timer handle returned by `Server::scheduleTimer()`.
+ */
+void FileTransfer::setExpiryTimer(TimerId id)
+{
+    _expiryTimer = id;
+}
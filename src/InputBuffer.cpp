@@ -0,0 +1,114 @@
+#include "../include/InputBuffer.hpp"
+#include <cstring>
+
+InputBuffer::InputBuffer()
+    : _storage()
+    , _start(0)
+    , _end(0)
+    , _scanned(0)
+    , _readSize(MIN_READ)
+{
+}
+
+const char* InputBuffer::data() const
+{
+    return _storage.data() + _start;
+}
+
+size_t InputBuffer::size() const
+{
+    return _end - _start;
+}
+
+bool InputBuffer::empty() const
+{
+    return _start == _end;
+}
+
+/**
+ * @brief Makes room after the data: moves it to the front if that is enough,
+ * otherwise grows the storage geometrically.
+ */
+char* InputBuffer::prepare(size_t length)
+{
+    if (_storage.size() - _end < length) {
+        size_t used = size();
+        if (_start > 0 && _storage.size() - used >= length) {
+            std::memmove(_storage.data(), _storage.data() + _start, used);
+        } else {
+            size_t capacity = _storage.size() ? _storage.size() * 2 : length;
+            if (capacity < used + length)
+                capacity = used + length;
+            std::vector<char> grown(capacity);
+            if (used)
+                std::memcpy(grown.data(), _storage.data() + _start, used);
+            _storage.swap(grown);
+        }
+        _start = 0;
+        _end = used;
+    }
+    return _storage.data() + _end;
+}
+
+void InputBuffer::commit(size_t length)
+{
+    _end += length;
+}
+
+void InputBuffer::consume(size_t length)
+{
+    _start += length;
+    _scanned = _scanned > length ? _scanned - length : 0;
+    if (_start >= _end) {
+        _start = 0;
+        _end = 0;
+        _scanned = 0;
+    }
+}
+
+/**
+ * @brief Looks for "\n" with `memchr()`, starting where the previous call stopped.
+ */
+bool InputBuffer::nextLine(std::string_view& line)
+{
+    if (_scanned >= size())
+        return false; // Nothing new since the last scan.
+
+    const char* begin = data();
+    const char* newline = static_cast<const char*>(
+        std::memchr(begin + _scanned, '\n', size() - _scanned));
+    if (!newline) {
+        _scanned = size();
+        return false;
+    }
+
+    size_t length = newline - begin;
+    line = std::string_view(begin, length);
+    if (length > 0 && line[length - 1] == '\r')
+        line.remove_suffix(1);
+    consume(length + 1);
+    return true;
+}
+
+size_t InputBuffer::readSize() const
+{
+    return _readSize;
+}
+
+/**
+ * @brief Doubles the read size after a full read, halves it after a read that
+ * used less than a quarter of it.
+ */
+void InputBuffer::adaptReadSize(size_t requested, size_t received)
+{
+    if (received >= requested && _readSize < MAX_READ)
+        _readSize *= 2;
+    else if (received < requested / 4 && _readSize > MIN_READ)
+        _readSize /= 2;
+}
+
+void InputBuffer::shrink()
+{
+    if (empty() && _storage.size() > KEEP_CAPACITY)
+        std::vector<char>().swap(_storage);
+}
@@ -0,0 +1,65 @@
+#include "../include/IrcMessage.hpp"
+
+IrcMessage::IrcMessage()
+    : tags()
+    , prefix()
+    , command()
+    , params()
+    , paramCount(0)
+    , hasTrailing(false)
+{
+}
+
+/**
+ * @brief Returns the word starting at `pos` and moves `pos` past it and the spaces that follow.
+ */
+static std::string_view nextWord(std::string_view line, size_t& pos)
+{
+    size_t end = line.find(' ', pos);
+    if (end == std::string_view::npos)
+        end = line.size();
+    std::string_view word = line.substr(pos, end - pos);
+    pos = line.find_first_not_of(' ', end);
+    if (pos == std::string_view::npos)
+        pos = line.size();
+    return word;
+}
+
+bool IrcMessage::parse(std::string_view line)
+{
+    *this = IrcMessage();
+
+    size_t pos = line.find_first_not_of(' ');
+    if (pos == std::string_view::npos)
+        return false;
+
+    if (line[pos] == '@')
+        tags = nextWord(line, ++pos);
+    if (pos < line.size() && line[pos] == ':')
+        prefix = nextWord(line, ++pos);
+    if (pos == line.size())
+        return false;
+    command = nextWord(line, pos);
+
+    while (pos < line.size()) {
+        if (line[pos] == ':' || paramCount == MAX_PARAMS - 1) {
+            if (line[pos] == ':')
+                ++pos;
+            params[paramCount++] = line.substr(pos);
+            hasTrailing = true;
+            break;
+        }
+        params[paramCount++] = nextWord(line, pos);
+    }
+    return true;
+}
+
+std::string_view IrcMessage::param(size_t index) const
+{
+    return index < paramCount ? params[index] : std::string_view();
+}
+
+std::string_view IrcMessage::trailing() const
+{
+    return hasTrailing ? params[paramCount - 1] : std::string_view();
+}
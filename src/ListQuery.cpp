@@ -0,0 +1,91 @@
+#include "../include/ListQuery.hpp"
+#include "../include/Utils.hpp"
+#include <charconv>
+#include <climits>
+
+ListQuery::ListQuery()
+    : _above(-1)
+    , _below(LLONG_MAX)
+    , _names()
+    , _excludes()
+    , _topics()
+    , _position()
+{
+}
+
+/**
+ * @brief Splits the conditions on commas and sorts them by kind.
+ *
+ * A `>N`/`<N` with a malformed number is dropped; several of them narrow the
+ * range (`>10,<100`).
+ */
+ListQuery::ListQuery(std::string_view filters)
+    : ListQuery()
+{
+    while (!filters.empty()) {
+        size_t comma = filters.find(',');
+        std::string_view condition = filters.substr(0, comma);
+        filters = comma == std::string_view::npos ? std::string_view() : filters.substr(comma + 1);
+        if (condition.empty())
+            continue;
+
+        if (condition[0] == '>' || condition[0] == '<') {
+            long long count = 0;
+            const char* end = condition.data() + condition.size();
+            std::from_chars_result result = std::from_chars(condition.data() + 1, end, count);
+            if (result.ec != std::errc() || result.ptr != end || count < 0)
+                continue;
+            if (condition[0] == '>' && count > _above)
+                _above = count;
+            else if (condition[0] == '<' && count < _below)
+                _below = count;
+        } else if (condition[0] == '!') {
+            if (condition.size() > 1)
+                _excludes.push_back(std::string(condition.substr(1)));
+        } else if (condition.size() > 2 && (condition[0] == 'T' || condition[0] == 't') && condition[1] == ':') {
+            _topics.push_back(std::string(condition.substr(2)));
+        } else {
+            _names.push_back(std::string(condition));
+        }
+    }
+}
+
+bool ListQuery::matches(const Channel& channel) const
+{
+    long long members = static_cast<long long>(channel.getClients().size());
+    if (members <= _above || members >= _below)
+        return false;
+
+    const std::string& name = channel.getName();
+    if (!_names.empty()) {
+        bool named = false;
+        for (size_t i = 0; i < _names.size() && !named; ++i)
+            named = Utils::matchMask(_names[i], name);
+        if (!named)
+            return false;
+    }
+    for (size_t i = 0; i < _excludes.size(); ++i) {
+        if (Utils::matchMask(_excludes[i], name))
+            return false;
+    }
+    if (!_topics.empty()) {
+        const std::string& topic = channel.getTopic();
+        bool found = false;
+        for (size_t i = 0; i < _topics.size() && !found; ++i)
+            found = Utils::matchMask(_topics[i], topic);
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
+bool ListQuery::isExact() const
+{
+    if (_names.empty() || !_excludes.empty())
+        return false;
+    for (size_t i = 0; i < _names.size(); ++i) {
+        if (_names[i].find_first_of("*?") != std::string::npos)
+            return false;
+    }
+    return true;
+}
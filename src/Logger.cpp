@@ -0,0 +1,286 @@
+#include "../include/Logger.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <unistd.h>
+
+static const size_t LOG_RING_SLOTS = 4096; ///< Capacity of the ring (a power of two).
+static const size_t LOG_LINE_MAX = 480; ///< Longest line kept; the rest is cut.
+
+/** @brief One queued line. `sequence` tells producers and the writer whose turn it is. */
+struct LogSlot
+{
+    std::atomic<size_t> sequence;
+    LogLevel level;
+    time_t time;
+    uint16_t length;
+    char text[LOG_LINE_MAX];
+};
+
+/** @brief The ring; slot `i` starts free for the producer holding position `i`. */
+struct LogRing
+{
+    LogRing()
+    {
+        for (size_t i = 0; i < LOG_RING_SLOTS; ++i)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    LogSlot slots[LOG_RING_SLOTS];
+};
+
+static LogRing s_ring;
+static std::atomic<size_t> s_enqueuePos(0); ///< Next position claimed by a producer.
+static size_t s_dequeuePos = 0; ///< Next position read by the writer (writer thread only).
+static std::atomic<size_t> s_dropped(0); ///< Lines lost because the ring was full.
+static std::atomic<int> s_level(LOG_LEVEL_INFO);
+static std::atomic<time_t> s_now(0);
+
+static std::atomic<bool> s_running(false);
+static std::atomic<bool> s_writerSleeping(false);
+static std::mutex s_wakeMutex;
+static std::condition_variable s_wakeCondition;
+static std::thread s_writer;
+
+static const char* levelTag(LogLevel level)
+{
+    switch (level) {
+    case LOG_LEVEL_DEBUG:
+        return "[DEBUG] ";
+    case LOG_LEVEL_INFO:
+        return "[INFO] ";
+    case LOG_LEVEL_WARN:
+        return "[WARN] ";
+    default:
+        return "[ERROR] ";
+    }
+}
+
+/**
+ * @brief Writes a whole buffer to a descriptor, retrying short writes.
+ */
+static void writeAll(int fd, std::string& buffer)
+{
+    size_t done = 0;
+    while (done < buffer.size()) {
+        ssize_t written = ::write(fd, buffer.data() + done, buffer.size() - done);
+        if (written <= 0)
+            break; // Nowhere to report it: drop the rest.
+        done += written;
+    }
+    buffer.clear();
+}
+
+/**
+ * @brief Formats "[date] " for a time, re-formatting only when the second changes.
+ */
+struct LogStamp
+{
+    LogStamp()
+        : time(-1)
+    {
+        text[0] = '\0';
+    }
+
+    const char* format(time_t when)
+    {
+        if (when != time) {
+            struct tm local;
+            localtime_r(&when, &local);
+            strftime(text, sizeof(text), "[%Y-%m-%d %H:%M:%S] ", &local);
+            time = when;
+        }
+        return text;
+    }
+
+    time_t time;
+    char text[32];
+};
+
+/**
+ * @brief Appends one formatted line: "[date] [LEVEL] text\n".
+ */
+static void formatLine(std::string& out, LogStamp& stamp, LogLevel level, time_t when,
+    std::string_view text)
+{
+    out += stamp.format(when);
+    out += levelTag(level);
+    out.append(text.data(), text.size());
+    out += '\n';
+}
+
+/**
+ * @brief Moves every published line out of the ring into the output batches.
+ *
+ * @return `true` if at least one line was taken.
+ */
+static bool drainRing(std::string& out, std::string& err, LogStamp& stamp)
+{
+    bool any = false;
+    while (true) {
+        LogSlot& slot = s_ring.slots[s_dequeuePos & (LOG_RING_SLOTS - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != s_dequeuePos + 1)
+            break; // Not published yet.
+        formatLine(slot.level >= LOG_LEVEL_WARN ? err : out, stamp, slot.level, slot.time,
+            std::string_view(slot.text, slot.length));
+        slot.sequence.store(s_dequeuePos + LOG_RING_SLOTS, std::memory_order_release);
+        ++s_dequeuePos;
+        any = true;
+    }
+
+    size_t dropped = s_dropped.exchange(0);
+    if (dropped) {
+        formatLine(err, stamp, LOG_LEVEL_WARN, s_now.load(std::memory_order_relaxed),
+            std::to_string(dropped) + " log lines dropped (logger ring full)");
+    }
+    return any || dropped;
+}
+
+static bool ringEmpty()
+{
+    const LogSlot& slot = s_ring.slots[s_dequeuePos & (LOG_RING_SLOTS - 1)];
+    return slot.sequence.load(std::memory_order_seq_cst) != s_dequeuePos + 1;
+}
+
+/**
+ * @brief Writer thread: drains and writes in batches, sleeps while the ring is empty.
+ */
+static void writerLoop()
+{
+    std::string out;
+    std::string err;
+    LogStamp stamp;
+    while (true) {
+        while (drainRing(out, err, stamp)) {
+            writeAll(STDOUT_FILENO, out);
+            writeAll(STDERR_FILENO, err);
+        }
+        if (!s_running.load())
+            break;
+
+        std::unique_lock<std::mutex> lock(s_wakeMutex);
+        s_writerSleeping.store(true); // Ordered with the producers' publish, see write().
+        if (ringEmpty() && s_running.load())
+            s_wakeCondition.wait(lock);
+        s_writerSleeping.store(false);
+    }
+}
+
+void Logger::start()
+{
+    tick();
+    if (s_running.exchange(true))
+        return;
+
+    // Signals are for the main thread.
+    sigset_t blocked;
+    sigset_t previous;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGQUIT);
+    pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+    s_writer = std::thread(writerLoop);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
+
+void Logger::stop()
+{
+    if (!s_running.exchange(false))
+        return;
+    {
+        std::lock_guard<std::mutex> lock(s_wakeMutex);
+        s_wakeCondition.notify_one();
+    }
+    s_writer.join();
+}
+
+void Logger::setLevel(LogLevel level)
+{
+    s_level.store(level, std::memory_order_relaxed);
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level)
+{
+    static const char* const names[] = { "debug", "info", "warn", "error" };
+    for (int i = 0; i < 4; ++i) {
+        if (name == names[i]) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Logger::enabled(LogLevel level)
+{
+    return level >= s_level.load(std::memory_order_relaxed);
+}
+
+void Logger::tick()
+{
+    s_now.store(std::time(NULL), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Claims a slot, copies the line into it and publishes it.
+ *
+ * Lock-free: producers only race on `s_enqueuePos`. The writer is woken only
+ * when it is asleep, so a busy logger costs no system call per line. Without
+ * a writer thread (before `start()` or after `stop()`) the line is written
+ * synchronously.
+ */
+void Logger::write(LogLevel level, std::string_view text)
+{
+    if (text.size() > LOG_LINE_MAX)
+        text = text.substr(0, LOG_LINE_MAX);
+
+    if (!s_running.load(std::memory_order_relaxed)) {
+        std::string line;
+        LogStamp stamp;
+        formatLine(line, stamp, level, std::time(NULL), text);
+        writeAll(level >= LOG_LEVEL_WARN ? STDERR_FILENO : STDOUT_FILENO, line);
+        return;
+    }
+
+    size_t pos = s_enqueuePos.load(std::memory_order_relaxed);
+    LogSlot* slot;
+    while (true) {
+        slot = &s_ring.slots[pos & (LOG_RING_SLOTS - 1)];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (s_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            s_dropped.fetch_add(1, std::memory_order_relaxed); // Full: the writer is behind.
+            return;
+        } else {
+            pos = s_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->time = s_now.load(std::memory_order_relaxed);
+    slot->length = static_cast<uint16_t>(text.size());
+    std::memcpy(slot->text, text.data(), text.size());
+    // Both this store and the load below are sequentially consistent: either the
+    // writer sees the line before sleeping, or we see it asleep and wake it.
+    slot->sequence.store(pos + 1, std::memory_order_seq_cst);
+    if (s_writerSleeping.load()) {
+        std::lock_guard<std::mutex> lock(s_wakeMutex);
+        s_wakeCondition.notify_one();
+    }
+}
+
+std::ostringstream& Logger::stream()
+{
+    static thread_local std::ostringstream stream;
+    stream.str(std::string());
+    stream.clear();
+    return stream;
+}
@@ -0,0 +1,116 @@
+#include "../include/OutputQueue.hpp"
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+OutputQueue::OutputQueue()
+    : _segments()
+    , _size(0)
+{
+}
+
+bool OutputQueue::empty() const
+{
+    return _size == 0;
+}
+
+size_t OutputQueue::size() const
+{
+    return _size;
+}
+
+/**
+ * @brief Queues a copy of `data`, starting at `offset`.
+ *
+ * If the last segment is private and still small, the bytes are appended to
+ * it; otherwise a new private segment is started.
+ */
+void OutputQueue::append(std::string_view data, size_t offset)
+{
+    if (offset >= data.size())
+        return;
+    size_t length = data.size() - offset;
+
+    if (!_segments.empty()) {
+        Segment& last = _segments.back();
+        if (last.owned && last.owned->size() + length <= COALESCE_LIMIT) {
+            last.owned->append(data, offset, length);
+            _size += length;
+            return;
+        }
+    }
+
+    std::shared_ptr<std::string> copy = std::make_shared<std::string>(data.substr(offset));
+    Segment segment;
+    segment.owned = copy.get();
+    segment.data = copy;
+    segment.offset = 0;
+    _segments.push_back(segment);
+    _size += length;
+}
+
+/**
+ * @brief Queues a shared segment by reference.
+ *
+ * The segment is never written to; later private appends start a new segment.
+ */
+void OutputQueue::append(const SharedMessage& segment)
+{
+    if (!segment || segment->empty())
+        return;
+
+    Segment entry;
+    entry.data = segment;
+    entry.owned = NULL;
+    entry.offset = 0;
+    _segments.push_back(entry);
+    _size += segment->size();
+}
+
+/**
+ * @brief Gathers the first `IOV_BATCH` segments into one `sendmsg()` call.
+ */
+ssize_t OutputQueue::writeTo(int fd)
+{
+    if (_size == 0)
+        return 0;
+
+    struct iovec iov[IOV_BATCH];
+    size_t count = 0;
+    for (std::deque<Segment>::const_iterator it = _segments.begin();
+        it != _segments.end() && count < IOV_BATCH; ++it, ++count) {
+        iov[count].iov_base = const_cast<char*>(it->data->data() + it->offset);
+        iov[count].iov_len = it->data->size() - it->offset;
+    }
+
+    struct msghdr msg = msghdr();
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+    ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent > 0)
+        consume(static_cast<size_t>(sent));
+    return sent;
+}
+
+void OutputQueue::clear()
+{
+    _segments.clear();
+    _size = 0;
+}
+
+/**
+ * @brief Pops fully sent segments and advances the offset of a partially sent one.
+ */
+void OutputQueue::consume(size_t count)
+{
+    _size -= count;
+    while (count > 0) {
+        Segment& front = _segments.front();
+        size_t left = front.data->size() - front.offset;
+        if (count < left) {
+            front.offset += count;
+            return;
+        }
+        count -= left;
+        _segments.pop_front();
+    }
+}
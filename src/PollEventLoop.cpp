@@ -0,0 +1,121 @@
+#include "../include/PollEventLoop.hpp"
+
+PollEventLoop::PollEventLoop()
+{
+}
+
+PollEventLoop::~PollEventLoop()
+{
+}
+
+const char* PollEventLoop::getName() const
+{
+    return "poll";
+}
+
+/**
+ * @brief Finds the `pollfd` entry of a descriptor.
+ *
+ * @param fd The descriptor to look for.
+ * @return Its index in `_pollFds`, or `-1` if it is not registered.
+ */
+int PollEventLoop::findSlot(int fd) const
+{
+    if (fd < 0 || static_cast<size_t>(fd) >= _slots.size())
+        return -1;
+    return _slots[fd];
+}
+
+/**
+ * @brief Appends a `pollfd` entry for the descriptor and records its slot.
+ *
+ * `poll()` is always level-triggered, so `edgeTriggered` is ignored.
+ */
+void PollEventLoop::addFd(int fd, unsigned int events, bool /*edgeTriggered*/)
+{
+    if (findSlot(fd) >= 0) {
+        modifyFd(fd, events);
+        return;
+    }
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = 0;
+    pfd.revents = 0;
+    if (events & IO_READ)
+        pfd.events |= POLLIN;
+    if (events & IO_WRITE)
+        pfd.events |= POLLOUT;
+
+    if (static_cast<size_t>(fd) >= _slots.size())
+        _slots.resize(fd + 1, -1);
+    _slots[fd] = static_cast<int>(_pollFds.size());
+    _pollFds.push_back(pfd);
+}
+
+/**
+ * @brief Rewrites the interest mask of an existing entry.
+ */
+void PollEventLoop::modifyFd(int fd, unsigned int events)
+{
+    int slot = findSlot(fd);
+    if (slot < 0)
+        return;
+    _pollFds[slot].events = 0;
+    if (events & IO_READ)
+        _pollFds[slot].events |= POLLIN;
+    if (events & IO_WRITE)
+        _pollFds[slot].events |= POLLOUT;
+}
+
+/**
+ * @brief Removes the entry of a descriptor in O(1).
+ *
+ * The last entry is moved into the freed slot, so the order of `_pollFds`
+ * changes; nothing depends on it.
+ */
+void PollEventLoop::removeFd(int fd)
+{
+    int slot = findSlot(fd);
+    if (slot < 0)
+        return;
+
+    int last = static_cast<int>(_pollFds.size()) - 1;
+    if (slot != last) {
+        _pollFds[slot] = _pollFds[last];
+        _slots[_pollFds[slot].fd] = slot;
+    }
+    _pollFds.pop_back();
+    _slots[fd] = -1;
+}
+
+/**
+ * @brief Calls `poll()` and collects every entry with non-zero `revents`.
+ *
+ * `POLLHUP`, `POLLERR` and `POLLNVAL` are folded into `IO_READ` so that the
+ * owner notices the failure on its next read. The scan stops once the `count`
+ * entries reported by `poll()` have been collected.
+ */
+int PollEventLoop::wait(std::vector<IoEvent>& ready, int timeoutMs)
+{
+    ready.clear();
+    int count = poll(_pollFds.data(), _pollFds.size(), timeoutMs);
+    if (count <= 0)
+        return count;
+
+    for (size_t i = 0; i < _pollFds.size() && static_cast<int>(ready.size()) < count; ++i) {
+        short revents = _pollFds[i].revents;
+        if (revents == 0)
+            continue;
+
+        IoEvent ev;
+        ev.fd = _pollFds[i].fd;
+        ev.events = 0;
+        if (revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL))
+            ev.events |= IO_READ;
+        if (revents & POLLOUT)
+            ev.events |= IO_WRITE;
+        ready.push_back(ev);
+    }
+    return static_cast<int>(ready.size());
+}
@@ -1,9 +1,90 @@
 #include "Replies.hpp"
-#include <sys/socket.h>
+#include <charconv>
+#include <string.h>
 #include <string>
+#include "../include/Channel.hpp"
 #include "../include/Client.hpp"
 #include "../include/Server.hpp"
 
+Reply::Reply(Server* server, int fd, const Numeric& numeric)
+    : _server(server)
+    , _fd(fd)
+    , _defaultText(numeric.text)
+    , _inText(false)
+    , _length(0)
+{
+    Client* client = server->getClients()[fd];
+    std::string_view nick = client ? std::string_view(client->getNickname()) : std::string_view();
+
+    put(":");
+    put(server->getServerName());
+    put(" ");
+    put(numeric.command);
+    put(" ");
+    put(nick.empty() ? "*" : nick);
+}
+
+Reply& Reply::param(std::string_view value)
+{
+    put(" ");
+    put(value);
+    return *this;
+}
+
+Reply& Reply::param(long long value)
+{
+    put(" ");
+    putNumber(value);
+    return *this;
+}
+
+Reply& Reply::text(std::string_view value)
+{
+    if (!_inText) {
+        put(" :");
+        _inText = true;
+    }
+    put(value);
+    return *this;
+}
+
+Reply& Reply::text(long long value)
+{
+    text(std::string_view());
+    putNumber(value);
+    return *this;
+}
+
+/**
+ * @brief Finishes the line and queues it for the client.
+ *
+ * `put()` always leaves room for the CRLF, so a truncated reply is still a
+ * well-formed line.
+ */
+void Reply::send()
+{
+    if (!_inText && _defaultText)
+        text(_defaultText);
+    _line[_length++] = '\r';
+    _line[_length++] = '\n';
+    _server->safeSend(_fd, std::string_view(_line, _length));
+}
+
+void Reply::put(std::string_view bytes)
+{
+    size_t room = MAX_LINE - 2 - _length;
+    size_t count = bytes.size() < room ? bytes.size() : room;
+    memcpy(_line + _length, bytes.data(), count);
+    _length += count;
+}
+
+void Reply::putNumber(long long value)
+{
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    put(std::string_view(digits, result.ptr - digits));
+}
+
 /**
  * @brief Sends the welcome message sequence to a newly registered client.
  *
@@ -13,6 +94,8 @@
  *  - 002: RPL_YOURHOST - Information about the server and its version.
  *  - 003: RPL_CREATED - A message indicating when the server was created.
  *  - 004: RPL_MYINFO - Server details including supported user modes.
+ *  - 005: RPL_ISUPPORT - Server limits and features clients can rely on
+ *    (MAXTARGETS, and LIST's filters and streaming).
  *
  * @param server Pointer to the Server instance.
  * @param fd The file descriptor of the client receiving the welcome message.
@@ -20,29 +103,79 @@
 void sendWelcome(Server* server, int fd)
 {
     // Retrieve client and server details.
-    Client*     client = server->getClients()[fd].get();
-    std::string nick   = client->getNickname();
-    std::string srv    = server->getServerName();
+    const std::string& nick = server->getClients()[fd]->getNickname();
+    const std::string& srv  = server->getServerName();
 
     // 001: RPL_WELCOME - Confirms successful connection and registration.
-    std::string rpl1 = ":" + srv + " 001 " + nick + " :Welcome to " + srv +
-                       ", " + nick + "!\r\n";
+    Reply(server, fd, RPL_WELCOME).text("Welcome to ").text(srv).text(", ").text(nick).text("!").send();
 
     // 002: RPL_YOURHOST - Displays server host and version.
-    std::string rpl2 = ":" + srv + " 002 " + nick + " :Your host is " + srv +
-                       ", running version 1.0\r\n";
+    Reply(server, fd, RPL_YOURHOST).text("Your host is ").text(srv).text(", running version 1.0").send();
 
     // 003: RPL_CREATED - Indicates when the server was initialized.
-    std::string rpl3 =
-        ":" + srv + " 003 " + nick + " :This server was created just now\r\n";
+    Reply(server, fd, RPL_CREATED).send();
 
     // 004: RPL_MYINFO - Provides server details and supported user modes.
-    std::string rpl4 =
-        ":" + srv + " 004 " + nick + " " + srv + " 1.0 iwtov\r\n";
-
-    // Send the responses to the client.
-    send(fd, rpl1.c_str(), rpl1.size(), 0);
-    send(fd, rpl2.c_str(), rpl2.size(), 0);
-    send(fd, rpl3.c_str(), rpl3.size(), 0);
-    send(fd, rpl4.c_str(), rpl4.size(), 0);
+    Reply(server, fd, RPL_MYINFO).param(srv).param("1.0").param("iwtov").send();
+
+    // 005: RPL_ISUPPORT - Advertises how many targets PRIVMSG/NOTICE accept,
+    // and that LIST takes ELIST filters and is streamed (SAFELIST).
+    std::string targets = std::to_string(server->getMaxTargets());
+    Reply(server, fd, RPL_ISUPPORT).param("MAXTARGETS=" + targets)
+        .param("TARGMAX=PRIVMSG:" + targets + ",NOTICE:" + targets)
+        .param("SAFELIST").param("ELIST=MNU").send();
+}
+
+/**
+ * @brief Sends a channel's member list (353 replies, then 366) to a client.
+ *
+ * The list is rendered once and cached on the channel (see
+ * `Channel::getCachedNames()`); it is only rebuilt after a change the cache
+ * cannot follow. It is then split at spaces into as many 353 lines as needed
+ * for each to fit in 512 bytes, given the recipient's own nickname.
+ *
+ * @param server Pointer to the Server instance.
+ * @param fd The file descriptor of the client receiving the list.
+ * @param channel The channel.
+ */
+void sendNames(Server* server, int fd, Channel& channel)
+{
+    const std::string* names = channel.getCachedNames();
+    if (!names) {
+        std::string rendered;
+        const std::vector<ClientId>& members = channel.getClients();
+        for (size_t i = 0; i < members.size(); ++i) {
+            if (i)
+                rendered += ' ';
+            if (channel.getMemberFlags(members[i]) & MEMBER_OPERATOR)
+                rendered += '@';
+            rendered += server->getClients().find(members[i])->getNickname();
+        }
+        channel.setCachedNames(rendered);
+        names = channel.getCachedNames();
+    }
+
+    std::string_view rest = *names;
+    while (!rest.empty()) {
+        Reply line(server, fd, RPL_NAMREPLY);
+        line.param("=").param(channel.getName()).text(std::string_view());
+
+        // Cut after the last name that fits; a name longer than a whole line is truncated.
+        size_t cut = rest.size();
+        size_t next = rest.size();
+        if (cut > line.room()) {
+            cut = rest.rfind(' ', line.room());
+            if (cut == std::string_view::npos) {
+                cut = line.room();
+                next = rest.find(' ');
+            } else {
+                next = cut;
+            }
+        }
+        line.text(rest.substr(0, cut)).send();
+        rest.remove_prefix(next == std::string_view::npos ? rest.size() : next);
+        if (!rest.empty())
+            rest.remove_prefix(1); // The separating space.
+    }
+    Reply(server, fd, RPL_ENDOFNAMES).param(channel.getName()).send();
 }
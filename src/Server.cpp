@@ -1,125 +1,388 @@
 #include "../include/Server.hpp"
-#include "../commands/BotCommand.hpp"
-#include "../commands/Cap.hpp"
-#include "../commands/FileCommand.hpp"
-#include "../commands/Invite.hpp"
-#include "../commands/Join.hpp"
-#include "../commands/Kick.hpp"
-#include "../commands/List.hpp"
-#include "../commands/Mode.hpp"
-#include "../commands/Nick.hpp"
-#include "../commands/Part.hpp"
-#include "../commands/Pass.hpp"
-#include "../commands/Privmsg.hpp"
-#include "../commands/Quit.hpp"
-#include "../commands/Topic.hpp"
-#include "../commands/User.hpp"
-#include "../commands/Who.hpp"
-#include "../commands/Whois.hpp"
+#include "../include/CommandTable.hpp"
+#include "../include/IrcMessage.hpp"
+#include "../include/ListQuery.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Replies.hpp"
 #include "../include/Utils.hpp"
 #include <algorithm>
 #include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
 #include <cstring>
 #include <fcntl.h>
-#include <iostream>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <stdexcept>
+#include <string_view>
 #include <unistd.h>
 
 std::atomic_bool Server::s_shutdownRequested(false);
+int Server::s_shutdownWakeFd = -1;
+thread_local Server::Shard* Server::s_currentShard = NULL;
+
+// Connection timeouts, driven by each shard's timer wheel.
+static const uint64_t REGISTRATION_TIMEOUT_MS = 60 * 1000; ///< Time allowed to complete PASS/NICK/USER.
+static const uint64_t PING_INTERVAL_MS = 120 * 1000; ///< Idle time before the server sends a PING.
+static const uint64_t PING_TIMEOUT_MS = 60 * 1000; ///< Time allowed to answer that PING.
+
+// Connections accepted per wake-up of a listening socket; the rest wait for the next pass.
+static const int ACCEPT_BUDGET = 64;
+
+// Bytes read from one client per loop pass before the other clients get their turn.
+static const size_t READ_BUDGET = 256 * 1024;
+
+// LIST streaming: channels examined per client per pass, and the output queue
+// size at which a listing waits for the client to read.
+static const size_t LIST_SCAN_BATCH = 512;
+static const size_t LIST_OUTPUT_LIMIT = 64 * 1024;
+
+/**
+ * @brief Mail carrying a message for a single client.
+ *
+ * @param recipient The file descriptor of the client, owned by the receiving shard.
+ * @param line The message to queue.
+ */
+Server::Mail::Mail(int recipient, const SharedMessage& line)
+    : fd(recipient)
+    , message(line)
+    , members()
+    , except(0)
+    , epoch(0)
+{
+}
+
+/**
+ * @brief Mail carrying a channel delivery to the members one shard owns, but `except`.
+ *
+ * @param owned The members owned by the receiving shard, shared with the channel.
+ * @param line The message to queue.
+ * @param skip The member that does not receive it (0 for none).
+ * @param delivery The deduplicated delivery it belongs to, or 0.
+ */
+Server::Mail::Mail(const MemberList& owned, const SharedMessage& line, ClientId skip, uint64_t delivery)
+    : fd(-1)
+    , message(line)
+    , members(owned)
+    , except(skip)
+    , epoch(delivery)
+{
+}
+
+/**
+ * @brief Initializes an idle shard; its sockets are created by the Server constructor.
+ *
+ * @param shardIndex Position of the shard in `_shards`.
+ */
+Server::Shard::Shard(unsigned int shardIndex)
+    : index(shardIndex)
+    , listenFd(-1)
+    , spareFd(-1)
+    , eventLoop()
+    , readyEvents()
+    , clients()
+    , mailboxMutex()
+    , mailbox()
+    , hasMail(false)
+    , timers(TimerWheel::now())
+    , nowMs(TimerWheel::now())
+    , thread()
+{
+    wakeFds[0] = -1;
+    wakeFds[1] = -1;
+}
+
+/**
+ * @brief Returns the client owned by a shard on the given descriptor.
+ *
+ * The table is only touched by the shard's own thread, so the I/O path can
+ * look clients up without taking `_stateMutex`.
+ *
+ * @param shard The shard to search.
+ * @param fd The file descriptor of the client.
+ * @return The client, or `NULL` if the shard does not own `fd`.
+ */
+Client* Server::ownedClient(const Shard& shard, int fd)
+{
+    if (fd < 0 || static_cast<size_t>(fd) >= shard.clients.size())
+        return NULL;
+    return shard.clients[fd];
+}
+
 /**
  * @brief Flushes the output buffer for a client.
  *
  * This function attempts to send all pending data stored in the client's
- * `outBuffer`. It repeatedly calls `send()` until:
- * - The buffer is empty (all data has been sent).
+ * `outBuffer`. It repeatedly calls `OutputQueue::writeTo()`, which writes up
+ * to 64 queued segments per `sendmsg()`, until:
+ * - The queue is empty (all data has been sent).
  * - The socket is not ready for writing (`EAGAIN` / `EWOULDBLOCK`).
  * - A critical error occurs, in which case the client is removed from the server.
  *
- * If `send()` encounters a non-recoverable error, the function calls `removeClient()`
- * to disconnect the client.
+ * Write interest is only kept while data is pending: it is enabled when the
+ * socket fills up, and once the queue drains the event loop goes back to
+ * watching the socket for input only.
  *
- * @param server Pointer to the Server instance.
  * @param fd The file descriptor of the client whose output buffer is to be flushed.
  */
-static void flushClientOutBuffer(Server* server, int fd)
+void Server::flushClientOutBuffer(int fd)
 {
-    // Retrieve the map of connected clients.
-    auto& clients = server->getClients();
+    Shard& shard = *s_currentShard;
 
-    // Ensure the client exists before proceeding.
-    if (clients.find(fd) == clients.end())
+    // Ensure the client exists (and belongs to this thread) before proceeding.
+    Client* client = ownedClient(shard, fd);
+    if (!client || client->outBuffer.empty())
         return; // Client not found, nothing to flush.
 
-    // Get a pointer to the client.
-    Client* client = clients[fd].get();
-
-    // Attempt to send data until the buffer is empty or the socket is not writable.
+    // Attempt to send data until the queue is empty or the socket is not writable.
     while (!client->outBuffer.empty()) {
-        // Send as much data as possible from the buffer.
-        ssize_t sent = send(fd, client->outBuffer.c_str(), client->outBuffer.size(), 0);
+        // Send as much data as possible; the queue consumes what was written.
+        ssize_t sent = client->outBuffer.writeTo(fd);
 
         if (sent < 0) {
-            // If the socket is temporarily unavailable, exit and retry later.
+            // If the socket is temporarily unavailable, ask to be told when it drains.
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                break;
-            } else {
+                if (!client->writeWatched) {
+                    shard.eventLoop->modifyFd(fd, IO_READ | IO_WRITE);
+                    client->writeWatched = true;
+                }
+                return;
+            } else if (errno != EINTR) {
                 // If a serious error occurs, remove the client from the server.
-                server->removeClient(fd);
+                std::lock_guard<std::recursive_mutex> lock(_stateMutex);
+                removeClient(fd);
                 return;
             }
         }
+    }
 
-        // Remove the sent portion from the outBuffer.
-        client->outBuffer.erase(0, sent);
+    // Everything was written: stop watching for writability.
+    if (client->writeWatched) {
+        shard.eventLoop->modifyFd(fd, IO_READ);
+        client->writeWatched = false;
     }
 }
 
 /**
  * @brief Sends data to a client safely.
  *
- * This function ensures reliable data transmission to the client by:
- * 1. Attempting to flush any pending data stored in the client's `outBuffer`.
- * 2. Sending the new message immediately, if possible.
- * 3. If the socket cannot send all data (or is not ready for writing),
- *    the unsent portion is appended to the client's `outBuffer` to be sent later.
+ * The message is routed to the thread that owns the client's socket:
+ * - If the calling shard owns the client, the message is appended to its
+ *   output queue by `queueOwned()`, after any mail that other shards posted
+ *   earlier, so the client sees messages in the order they were produced.
+ * - Otherwise it is posted to the owner's mailbox; the owner queues it on its
+ *   next loop pass. Messages posted to one shard are delivered in order.
  *
- * This prevents data loss and ensures that messages are delivered in order, even
- * if the client’s socket is temporarily unable to receive data.
+ * Nothing is written here: every client with queued output is flushed once,
+ * at the end of the owner's loop pass, so all the replies produced by one
+ * batch of commands (e.g. JOIN + 332 + 353 + 366) leave in a single write.
  *
  * @param fd The file descriptor of the client to which the message is sent.
  * @param message The message to send.
  */
-void Server::safeSend(int fd, const std::string& message)
+void Server::safeSend(int fd, std::string_view message)
 {
-    // Retrieve the map of connected clients.
-    auto& clients = getClients();
-
     // Ensure the client exists before attempting to send data.
-    if (clients.find(fd) == clients.end())
+    Client* client = _clients[fd];
+    if (!client)
         return; // Client not found, no action needed.
 
+    Shard& owner = *_shards[client->getShard()];
+    if (&owner == s_currentShard) {
+        // Anything posted earlier by another shard must go out before this message.
+        drainMailbox(owner);
+        queueOwned(owner, fd, message);
+    } else {
+        postToShard(owner, Mail(fd, std::make_shared<const std::string>(message)));
+    }
+}
+
+/**
+ * @brief Sends a shared message to a client safely.
+ *
+ * Same routing as the `std::string` overload, but the message is queued by
+ * reference (on the owner's queue or in its mailbox) and never copied, so one
+ * message can be handed to any number of clients.
+ *
+ * @param fd The file descriptor of the client to which the message is sent.
+ * @param message The message to send.
+ */
+void Server::safeSend(int fd, const SharedMessage& message)
+{
+    Client* client = _clients[fd];
+    if (!client)
+        return;
+
+    Shard& owner = *_shards[client->getShard()];
+    if (&owner == s_currentShard) {
+        drainMailbox(owner);
+        queueOwned(owner, fd, message);
+    } else {
+        postToShard(owner, Mail(fd, message));
+    }
+}
+
+/**
+ * @brief Queues data for a client owned by the calling shard.
+ *
+ * The message is appended to the client's `outBuffer` and the client is put
+ * on the shard's list of clients to flush at the end of the pass (once, no
+ * matter how many messages it receives). A client whose socket is full is
+ * left to its `IO_WRITE` event instead.
+ *
+ * @param shard The calling shard, which owns `fd`.
+ * @param fd The file descriptor of the client to which the message is sent.
+ * @param message The message to send.
+ */
+void Server::queueOwned(Shard& shard, int fd, std::string_view message)
+{
     // Get a pointer to the client.
-    Client* client = clients[fd].get();
+    Client* client = ownedClient(shard, fd);
+    if (!client)
+        return; // Client not found (or already removed), no action needed.
+
+    client->outBuffer.append(message);
+    scheduleFlush(shard, client);
+}
+
+/**
+ * @brief Queues a shared message for a client owned by the calling shard, by reference.
+ *
+ * @param shard The calling shard, which owns `fd`.
+ * @param fd The file descriptor of the client to which the message is sent.
+ * @param message The message to send.
+ */
+void Server::queueOwned(Shard& shard, int fd, const SharedMessage& message)
+{
+    Client* client = ownedClient(shard, fd);
+    if (!client)
+        return;
+
+    client->outBuffer.append(message);
+    scheduleFlush(shard, client);
+}
 
-    // Flush any previously buffered data to avoid excessive memory growth.
-    flushClientOutBuffer(this, fd);
+/**
+ * @brief Puts a client with new output on the shard's flush list, once per pass.
+ *
+ * @param shard The calling shard, which owns the client.
+ * @param client The client.
+ */
+void Server::scheduleFlush(Shard& shard, Client* client)
+{
+    if (!client->flushQueued && !client->writeWatched) {
+        client->flushQueued = true;
+        shard.pendingFlush.push_back(client->getFd());
+    }
+}
 
-    // Attempt to send the new message immediately.
-    ssize_t sent = send(fd, message.c_str(), message.size(), 0);
+/**
+ * @brief Writes the output queued for the shard's clients during this pass.
+ *
+ * @param shard The calling shard.
+ */
+void Server::flushPendingOutput(Shard& shard)
+{
+    // Flushing may remove clients, never queue new ones: iterate a stable list.
+    std::vector<int> pending;
+    pending.swap(shard.pendingFlush);
+    for (size_t i = 0; i < pending.size(); ++i) {
+        Client* client = ownedClient(shard, pending[i]);
+        if (!client)
+            continue; // Removed since: closeRemovedClients() sends what is left.
+        client->flushQueued = false;
+        flushClientOutBuffer(pending[i]);
+    }
+    pending.clear();
+    if (shard.pendingFlush.empty())
+        shard.pendingFlush.swap(pending); // Keep the capacity for the next pass.
+}
 
-    if (sent < 0) {
-        // If the socket is temporarily unavailable, buffer the entire message for later.
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            client->outBuffer += message;
-        } else {
-            // For any other error, remove the client from the server.
-            removeClient(fd);
+/**
+ * @brief Posts mail to the mailbox of a shard.
+ *
+ * Only the first message of a batch writes to the wake-up pipe; the rest ride
+ * along until the owner drains the mailbox.
+ *
+ * @param shard The receiving shard (the owner of single-client mail).
+ * @param mail The message and its recipients.
+ */
+void Server::postToShard(Shard& shard, const Mail& mail)
+{
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(shard.mailboxMutex);
+        shard.mailbox.push_back(mail);
+        wake = !shard.hasMail;
+        shard.hasMail = true;
+    }
+    if (wake) {
+        char byte = 1;
+        if (write(shard.wakeFds[1], &byte, 1) < 0 && errno != EAGAIN)
+            LOG_ERROR("failed to wake shard " << shard.index);
+    }
+}
+
+/**
+ * @brief Delivers the messages other shards posted to this shard.
+ *
+ * Clients that disconnected since the message was posted are skipped. A
+ * client reached by several channel mails of one deduplicated delivery gets
+ * the first one only; its `mailEpoch` is only ever touched here, by its
+ * owner.
+ *
+ * @param shard The calling shard.
+ */
+void Server::drainMailbox(Shard& shard)
+{
+    std::vector<Mail> mail;
+    {
+        std::lock_guard<std::mutex> lock(shard.mailboxMutex);
+        if (!shard.hasMail)
+            return;
+        mail.swap(shard.mailbox);
+        shard.hasMail = false;
+    }
+
+    for (size_t i = 0; i < mail.size(); ++i) {
+        if (!mail[i].members) {
+            queueOwned(shard, mail[i].fd, mail[i].message);
+            continue;
+        }
+        // Channel delivery to the members this shard owns, checked by handle
+        // so a member that left and whose fd was reused is skipped.
+        const std::vector<ClientId>& members = *mail[i].members;
+        uint64_t epoch = mail[i].epoch;
+        for (size_t m = 0; m < members.size(); ++m) {
+            if (members[m] == mail[i].except)
+                continue;
+            Client* client = ownedClient(shard, ClientTable::fdOf(members[m]));
+            if (!client || client->getId() != members[m])
+                continue;
+            if (epoch) {
+                if (client->mailEpoch == epoch)
+                    continue;
+                client->mailEpoch = epoch;
+            }
+            client->outBuffer.append(mail[i].message);
+            scheduleFlush(shard, client);
         }
-    } else if (static_cast<size_t>(sent) < message.size()) {
-        // If only part of the message was sent, store the remaining part in the buffer.
-        client->outBuffer += message.substr(sent);
+    }
+}
+
+/**
+ * @brief Creates a non-blocking, close-on-exec pipe used to wake a shard.
+ *
+ * @param fds Output array receiving the read and write ends.
+ * @throws std::runtime_error if the pipe cannot be created.
+ */
+static void createWakePipe(int fds[2])
+{
+    if (pipe(fds) < 0)
+        throw std::runtime_error("Failed to create wake-up pipe");
+    for (int i = 0; i < 2; ++i) {
+        if (fcntl(fds[i], F_SETFL, O_NONBLOCK) < 0 || fcntl(fds[i], F_SETFD, FD_CLOEXEC) < 0)
+            throw std::runtime_error("Failed to configure wake-up pipe");
     }
 }
 
@@ -130,71 +393,127 @@ void Server::safeSend(int fd, const std::string& message)
  * This constructor:
  * - Sets the port number and password.
  * - Initializes internal data structures, including maps for clients and channels.
- * - Calls `setupServer()` to configure the listening socket and prepare for incoming connections.
+ * - Creates one shard per thread, each with its own event loop, wake-up pipe
+ *   and listening socket (see `setupServer()`).
  *
  * @param port The port number on which the server listens for client connections.
  * @param password The password required for clients to connect (if applicable).
+ * @param eventLoop The event loop backend name ("epoll", "poll" or "" for the default).
+ * @param threads The number of event-loop threads (values below 1 are treated as 1).
  */
-Server::Server(int port, const std::string& password)
+Server::Server(int port, const std::string& password, const std::string& eventLoop,
+    unsigned int threads)
     : _port(port)
     , // Assign the specified port for the server.
-    _listen_fd(-1)
-    , // Initialize the listening socket file descriptor as invalid.
-    _poll_fds()
-    , // Initialize the poll descriptor list for handling multiple clients.
+    _shards()
+    , // Event-loop threads, created below.
     _password(password)
     , // Store the connection password.
     _clients()
-    , // Initialize the map to manage connected clients.
+    , // Initialize the table of connected clients.
     _channels()
     , // Initialize the map to store active IRC channels.
+    _notifyEpoch(0)
+    , // No peer notification sent yet.
+    _connectionsPerIp()
+    , // No connections yet.
+    _maxConnectionsPerIp(0)
+    , // No per-address limit unless configured.
+    _fanoutThreshold(0)
+    , // Channel deliveries stay on the calling thread unless configured.
+    _maxTargets(4)
+    , // PRIVMSG/NOTICE target limit, overridable with setMaxTargets().
     _serverName("AwesomeIRC") // Set the server's name (can be modified if needed).
 {
-    setupServer(); // Configure the listening socket and prepare for incoming connections.
+    if (threads < 1)
+        threads = 1;
+
+    for (unsigned int i = 0; i < threads; ++i)
+        _shards.push_back(std::unique_ptr<Shard>(new Shard(i)));
+
+    // Every shard exists before the first socket is bound, so all of them agree on SO_REUSEPORT.
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        Shard& shard = *_shards[i];
+        shard.eventLoop = EventLoop::create(eventLoop); // Readiness backend for this shard's sockets.
+        createWakePipe(shard.wakeFds);
+        shard.eventLoop->addFd(shard.wakeFds[0], IO_READ, false);
+        setupServer(shard); // Configure the listening socket and prepare for incoming connections.
+        shard.spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC); // Reserve, see shedConnection().
+    }
+    s_shutdownWakeFd = _shards[0]->wakeFds[1]; // Lets a signal interrupt an indefinite wait.
+
+    LOG_INFO("Server started on port " << _port << " (" << _shards[0]->eventLoop->getName()
+             << " event loop, " << threads << (threads == 1 ? " thread" : " threads") << ")");
 }
 
 /**
  * @brief Server destructor.
  *
- * Closes the listening socket if it is open.
+ * Closes the listening sockets and wake-up pipes of every shard.
  */
 Server::~Server()
 {
-    if (_listen_fd != -1)
-        close(_listen_fd);
+    s_shutdownWakeFd = -1;
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        Shard& shard = *_shards[i];
+        if (shard.thread.joinable())
+            shard.thread.join();
+        if (shard.listenFd != -1)
+            close(shard.listenFd);
+        if (shard.spareFd != -1)
+            close(shard.spareFd);
+        for (int j = 0; j < 2; ++j) {
+            if (shard.wakeFds[j] != -1)
+                close(shard.wakeFds[j]);
+        }
+    }
 }
 
 /**
- * @brief Sets up the server socket.
+ * @brief Sets up a shard's listening socket.
  *
  * This function:
  * - Creates a non-blocking TCP socket.
  * - Configures socket options to allow address reuse and disable Nagle's algorithm.
+ *   With several shards, `SO_REUSEPORT` lets each one bind its own socket to
+ *   the same port; the kernel then balances new connections between them.
  * - Binds the socket to the specified port.
  * - Starts listening for incoming connections.
- * - Adds the listening socket to the poll descriptor vector for event monitoring.
+ * - Registers the listening socket with the shard's event loop.
  *
+ * @param shard The shard that will accept on the socket.
  * @throws std::runtime_error if any socket operation fails.
  */
-void Server::setupServer()
+void Server::setupServer(Shard& shard)
 {
     // Create a TCP socket (IPv4, Stream-based)
-    _listen_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (_listen_fd < 0)
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0)
         throw std::runtime_error("Failed to create socket");
+    shard.listenFd = listenFd;
 
     // Enable SO_REUSEADDR to allow quick reuse of the port after server restart
     int opt = 1;
-    if (setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
+    if (setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
         throw std::runtime_error("setsockopt SO_REUSEADDR failed");
 
+    // Let every shard bind its own listening socket to the shared port
+    if (_shards.size() > 1) {
+#ifdef SO_REUSEPORT
+        if (setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+            throw std::runtime_error("setsockopt SO_REUSEPORT failed");
+#else
+        throw std::runtime_error("SO_REUSEPORT is not supported on this platform");
+#endif
+    }
+
     // Disable Nagle's algorithm (TCP_NODELAY) to reduce latency for small packets
     int flag = 1;
-    if (setsockopt(_listen_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) < 0)
+    if (setsockopt(listenFd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) < 0)
         throw std::runtime_error("setsockopt TCP_NODELAY failed");
 
     // Set the socket to non-blocking mode to avoid blocking on accept() calls
-    if (fcntl(_listen_fd, F_SETFL, O_NONBLOCK) < 0)
+    if (fcntl(listenFd, F_SETFL, O_NONBLOCK) < 0)
         throw std::runtime_error("Failed to set non-blocking mode");
 
     // Configure the server's address structure (IPv4)
@@ -205,291 +524,624 @@ void Server::setupServer()
     addr.sin_port = htons(_port); // Convert port to network byte order
 
     // Bind the socket to the specified address and port
-    if (bind(_listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
         throw std::runtime_error("bind failed");
 
     // Start listening for incoming connections (SOMAXCONN sets the maximum queue size)
-    if (listen(_listen_fd, SOMAXCONN) < 0)
+    if (listen(listenFd, SOMAXCONN) < 0)
         throw std::runtime_error("listen failed");
 
-    // Add the listening socket to the poll descriptor list for event monitoring
-    struct pollfd pfd;
-    pfd.fd = _listen_fd;
-    pfd.events = POLLIN; // Monitor for incoming connections
-    pfd.revents = 0;
-    _poll_fds.push_back(pfd);
+    // Watch the listening socket for incoming connections. It stays level-triggered,
+    // so connections left in the backlog are reported again on the next wait.
+    shard.eventLoop->addFd(listenFd, IO_READ, false);
+}
 
-    std::cout << "Server started on port " << _port << "\n";
+/**
+ * @brief Runs the server until shutdown is requested.
+ *
+ * Every shard but the first gets its own thread; the first runs on the
+ * calling thread. The extra threads are started with `SIGINT` and `SIGQUIT`
+ * blocked, so the signal handler always runs on the main thread, where it
+ * wakes the first shard; that shard then wakes the others.
+ */
+void Server::run()
+{
+    sigset_t blocked;
+    sigset_t previous;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGQUIT);
+    pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+    for (size_t i = 1; i < _shards.size(); ++i)
+        _shards[i]->thread = std::thread(&Server::runShard, this, std::ref(*_shards[i]));
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+    runShard(*_shards[0]);
+
+    for (size_t i = 1; i < _shards.size(); ++i)
+        _shards[i]->thread.join();
+    LOG_INFO("Server stopping gracefully.");
 }
 
 /**
- * @brief Runs the main server loop.
+ * @brief Runs the event loop of one shard.
  *
- * This function continuously monitors all active file descriptors using `poll()`
- * to handle incoming connections, process client data, and send pending messages.
- * It ensures smooth operation by:
- * - Updating the poll event flags based on each client's state.
+ * This function continuously waits on the shard's event loop to handle incoming
+ * connections, process client data, and send pending messages.
+ * Only the descriptors that became ready are visited:
  * - Accepting new connections when the listening socket is ready.
+ * - Delivering mail from other shards when the wake-up pipe is readable.
  * - Reading incoming data from active clients.
  * - Sending pending messages if a client's socket is ready for writing.
+ *
+ * Replies produced during the pass are queued, and each client with queued
+ * output is flushed once at the end of the pass (see `flushPendingOutput()`).
+ * Write interest is only enabled for sockets that fill up, by
+ * `flushClientOutBuffer()`, so no per-pass rebuild of the interest set is needed.
+ *
+ * There is no fixed poll interval: the loop sleeps until the next timer of the
+ * shard's wheel is due, or indefinitely when no timer is pending, so an idle
+ * server does not wake up at all. Due timers run after the I/O of each pass.
+ *
+ * @param shard The shard to run on the calling thread.
  */
-void Server::run()
+void Server::runShard(Shard& shard)
 {
-    // Main event loop – runs indefinitely while the server is active.
+    s_currentShard = &shard;
+
+    // Event loop – runs indefinitely while the server is active.
     while (true) {
-        // Update poll events for each client socket (skip the listening socket at index 0).
-        // If a client's `outBuffer` is non-empty, monitor both readability (POLLIN) and writability (POLLOUT).
         if (s_shutdownRequested.load()) {
-            std::cout << "[INFO] Shutdown requested, exiting run loop...\n";
+            if (shard.index == 0) {
+                LOG_INFO("Shutdown requested, exiting run loop...");
+                // The other shards may be sleeping without a timeout: wake them.
+                for (size_t i = 1; i < _shards.size(); ++i) {
+                    char byte = 1;
+                    if (write(_shards[i]->wakeFds[1], &byte, 1) < 0 && errno != EAGAIN)
+                        LOG_ERROR("failed to wake shard " << i);
+                }
+            }
             break;
         }
-        for (size_t i = 1; i < _poll_fds.size(); ++i) {
-            int fd = _poll_fds[i].fd;
-            auto& clients = getClients();
-
-            // Ensure the client still exists before updating poll flags.
-            if (clients.find(fd) != clients.end()) {
-                Client* client = clients[fd].get();
 
-                // If there is no pending output data, only check for incoming data (POLLIN).
-                // Otherwise, also check if the socket is ready to send data (POLLOUT).
-                _poll_fds[i].events = client->outBuffer.empty() ? POLLIN : (POLLIN | POLLOUT);
+        // Sleep until I/O is ready or the next timer is due (don't sleep if reads
+        // or listings are pending).
+        int timeout = shard.timers.nextTimeoutMs(TimerWheel::now());
+        if (!shard.pendingRead.empty() || hasListingToServe(shard))
+            timeout = 0;
+        int ready = shard.eventLoop->wait(shard.readyEvents, timeout);
+        shard.nowMs = TimerWheel::now();
+        Logger::tick(); // One clock sample stamps every log line of this pass.
+        if (ready < 0 && errno != EINTR)
+            LOG_ERROR("event loop wait error: " << std::strerror(errno)); // Timers still run below.
+
+        // Clients that used up their read budget last pass; served after this pass's events.
+        std::vector<int> readBacklog;
+        readBacklog.swap(shard.pendingRead);
+
+        // Process events for each ready file descriptor.
+        for (size_t i = 0; i < shard.readyEvents.size(); ++i) {
+            int fd = shard.readyEvents[i].fd;
+            unsigned int events = shard.readyEvents[i].events;
+
+            // If the listening socket is ready, accept a new client connection.
+            if (fd == shard.listenFd) {
+                acceptNewConnection(shard);
+                continue;
             }
-        }
 
-        // Monitor all file descriptors using `poll()` with a timeout of 100 milliseconds.
-        int poll_count = poll(_poll_fds.data(), _poll_fds.size(), 100);
-        if (poll_count < 0) {
-            std::cerr << "poll error\n";
-            continue; // Log the error and continue the loop.
-        }
+            // Another shard posted messages for our clients (or asked us to stop).
+            if (fd == shard.wakeFds[0]) {
+                char bytes[64];
+                while (read(shard.wakeFds[0], bytes, sizeof(bytes)) > 0) {
+                }
+                drainMailbox(shard);
+                continue;
+            }
 
-        // Process events for each file descriptor.
-        for (size_t i = 0; i < _poll_fds.size(); ++i) {
-            int fd = _poll_fds[i].fd;
+            // The client may have been removed while handling an earlier event.
+            if (!ownedClient(shard, fd))
+                continue;
 
-            // If the socket is ready for writing (POLLOUT), flush any buffered data.
-            if (_poll_fds[i].revents & POLLOUT) {
-                flushClientOutBuffer(this, fd);
+            // If the socket is ready for writing, flush any buffered data.
+            if (events & IO_WRITE) {
+                flushClientOutBuffer(fd);
             }
 
-            // If the socket is ready for reading (POLLIN):
-            if (_poll_fds[i].revents & POLLIN) {
-                // If the listening socket is ready, accept a new client connection.
-                if (fd == _listen_fd) {
-                    acceptNewConnection();
-                } else {
-                    // Otherwise, handle incoming data from an existing client.
-                    handleClientData(fd);
-                }
+            // If the socket is ready for reading, handle incoming data (backlogged clients wait their turn).
+            Client* client = ownedClient(shard, fd);
+            if ((events & IO_READ) && client && !client->readPending) {
+                handleClientData(fd);
             }
         }
+
+        // Give the backlogged clients another budget.
+        for (size_t i = 0; i < readBacklog.size(); ++i) {
+            Client* client = ownedClient(shard, readBacklog[i]);
+            if (!client)
+                continue;
+            client->readPending = false;
+            handleClientData(readBacklog[i]);
+        }
+
+        // Run the timers that are due (registration, keepalive, transfer expiry).
+        shard.timers.advance(shard.nowMs);
+
+        // Stream the next part of the LIST replies in progress.
+        serveListings(shard);
+
+        // Write everything queued during this pass, one flush per client.
+        flushPendingOutput(shard);
+
+        // Tear down the connections removed during this pass.
+        closeRemovedClients(shard);
     }
-    std::cout << "[INFO] Server stopping gracefully.\n";
 }
 
+/**
+ * @brief Requests a graceful shutdown.
+ *
+ * Only async-signal-safe operations are used: an atomic store and a `write()`
+ * to the first shard's wake-up pipe, which may be sleeping without a timeout.
+ */
 void Server::requestShutdown()
 {
     s_shutdownRequested.store(true);
+    if (s_shutdownWakeFd != -1) {
+        char byte = 1;
+        if (write(s_shutdownWakeFd, &byte, 1) < 0) {
+            // Nothing to do: the pipe is already full, so the loop is awake.
+        }
+    }
 }
 
 /**
- * @brief Accepts a new client connection.
+ * @brief Schedules a callback on the calling shard's timer wheel.
+ *
+ * The callback is wrapped so that it runs with `_stateMutex` held, like a
+ * command handler.
  *
- * This function handles new client connections by:
- * - Accepting the connection on the listening socket.
- * - Setting the client's socket to non-blocking mode.
- * - Disabling Nagle’s algorithm for improved responsiveness.
- * - Adding the client’s socket to the `poll` descriptor list.
- * - Creating a new `Client` object to manage the connection.
- * - Logging the client's IP address and port.
+ * @param delayMs Delay in milliseconds.
+ * @param callback The action to run.
+ * @return A handle for `cancelTimer()`.
+ */
+TimerId Server::scheduleTimer(uint64_t delayMs, const std::function<void()>& callback)
+{
+    return s_currentShard->timers.schedule(delayMs, [this, callback]() {
+        std::lock_guard<std::recursive_mutex> lock(_stateMutex);
+        callback();
+    });
+}
+
+/**
+ * @brief Cancels a timer scheduled on the calling shard.
  *
- * If any step fails, the connection is closed to prevent resource leaks.
+ * @param id The handle returned by `scheduleTimer()`.
  */
-void Server::acceptNewConnection()
+void Server::cancelTimer(TimerId id)
 {
-    // Structure to store the client's address information
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
+    s_currentShard->timers.cancel(id);
+}
 
-    // Accept a new connection from the listening socket
-    int client_fd = accept(_listen_fd, (struct sockaddr*)&client_addr, &client_len);
-    if (client_fd < 0) {
-        // If accept() fails due to a non-blocking socket, ignore and return.
-        if (errno != EWOULDBLOCK && errno != EAGAIN)
-            std::cerr << "accept failed\n";
+/**
+ * @brief Registration timeout: drops a client that never completed PASS/NICK/USER.
+ *
+ * @param fd The file descriptor of the client.
+ */
+void Server::checkRegistration(int fd)
+{
+    Client* client = ownedClient(*s_currentShard, fd);
+    if (!client)
         return;
-    }
+    client->registrationTimer = 0;
+    if (client->authState == AUTH_REGISTERED)
+        return;
+
+    LOG_INFO("Registration timeout for fd " << fd);
+    safeSend(fd, "ERROR :Closing Link: Registration timed out\r\n");
+    removeClient(fd);
+}
+
+/**
+ * @brief Keepalive timer of a client.
+ *
+ * - If the previous PING is still unanswered (nothing was received since),
+ *   the client is disconnected.
+ * - If the client was active less than `PING_INTERVAL_MS` ago, the timer is
+ *   re-armed for the rest of the interval.
+ * - Otherwise the client is sent a PING and given `PING_TIMEOUT_MS` to answer.
+ *
+ * @param fd The file descriptor of the client.
+ */
+void Server::checkKeepalive(int fd)
+{
+    Shard& shard = *s_currentShard;
+    Client* client = ownedClient(shard, fd);
+    if (!client)
+        return;
+    client->keepaliveTimer = 0;
 
-    // Set the client's socket to non-blocking mode
-    if (fcntl(client_fd, F_SETFL, O_NONBLOCK) < 0) {
-        std::cerr << "Failed to set non-blocking mode for client\n";
-        close(client_fd); // Close the socket to prevent leaks
+    if (client->awaitingPong) {
+        LOG_INFO("Ping timeout for fd " << fd);
+        safeSend(fd, "ERROR :Closing Link: Ping timeout\r\n");
+        removeClient(fd);
         return;
     }
 
-    // Disable Nagle’s algorithm to reduce latency for real-time communication
-    int flag = 1;
-    if (setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) < 0) {
-        std::cerr << "setsockopt TCP_NODELAY failed for client\n";
-        close(client_fd);
+    uint64_t idle = shard.nowMs - client->lastActivity;
+    if (idle < PING_INTERVAL_MS) {
+        client->keepaliveTimer = scheduleTimer(PING_INTERVAL_MS - idle, [this, fd]() { checkKeepalive(fd); });
         return;
     }
 
-    // Add the client’s socket to the poll descriptor list
-    struct pollfd pfd;
-    pfd.fd = client_fd; // Set file descriptor
-    pfd.events = POLLIN; // Monitor for incoming data
-    pfd.revents = 0; // Initialize event status
-    _poll_fds.push_back(pfd); // Register with the polling system
-
-    // Add the new client to the server's client list
-    getClients().emplace(client_fd, std::make_unique<Client>(client_fd));
-
-    // Log the successful connection with client IP and port
-    std::cout << "New connection from "
-              << inet_ntoa(client_addr.sin_addr) // Convert IP to readable format
-              << ":" << ntohs(client_addr.sin_port) // Convert port to host byte order
-              << " (fd: " << client_fd << ")\n";
+    safeSend(fd, "PING :" + _serverName + "\r\n");
+    if (!ownedClient(shard, fd))
+        return; // The send failed and removed the client.
+    client->awaitingPong = true;
+    client->keepaliveTimer = scheduleTimer(PING_TIMEOUT_MS, [this, fd]() { checkKeepalive(fd); });
 }
 
 /**
- * @brief Handles incoming data from a client.
+ * @brief Accepts the connections waiting on a shard's listening socket.
  *
- * This function performs the following steps:
- * 1. Reads data from the client socket in a **non-blocking** manner.
- * 2. If data is received, it is appended to the client's input buffer.
- * 3. The function continuously checks for **complete commands** (terminated by "\r\n" or "\n").
- * 4. When a complete command is found:
- *    - It is **extracted, trimmed**, and passed to `processCommand()`.
- *    - The command is then removed from the buffer.
- * 5. If the client **disconnects** (recv returns 0), it is removed from the server.
+ * After a reconnect wave thousands of clients may be queued in the backlog, so
+ * connections are accepted in a loop until `EAGAIN`, at most `ACCEPT_BUDGET`
+ * per call; the listening socket is level-triggered, so whatever is left is
+ * reported again on the next pass, after the shard has served its clients.
  *
- * @param fd File descriptor of the client.
+ * Each connection is created non-blocking and close-on-exec by `accept4()`,
+ * and inherits `TCP_NODELAY` from the listening socket, so no extra system
+ * call is needed per client. It is then:
+ * - refused with an `ERROR` if its address already holds the maximum number
+ *   of connections (see `setMaxConnectionsPerIp()`);
+ * - registered with the shard's event loop, with its registration and
+ *   keepalive timers armed.
+ *
+ * @param shard The shard accepting (and owning) the connections.
  */
-void Server::handleClientData(int fd)
+void Server::acceptNewConnection(Shard& shard)
 {
-    char buffer[512];
-    int bytes_received = recv(fd, buffer, sizeof(buffer), 0);
+    for (int accepted = 0; accepted < ACCEPT_BUDGET; ++accepted) {
+        // Structure to store the client's address information
+        struct sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+
+        // Accept a new connection from the listening socket
+        int client_fd = accept4(shard.listenFd, (struct sockaddr*)&client_addr, &client_len,
+            SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            int error = errno;
+            if (error == EINTR || error == ECONNABORTED)
+                continue; // Interrupted, or the peer gave up while queued.
+            if (error == EMFILE || error == ENFILE) {
+                if (shedConnection(shard))
+                    continue;
+                return; // Nothing left to shed.
+            }
+            // The backlog is empty (EAGAIN) or accept() failed: try again on the next pass.
+            if (error != EWOULDBLOCK && error != EAGAIN)
+                LOG_ERROR("accept failed: " << std::strerror(error));
+            return;
+        }
 
-    // If an error occurs while receiving data
-    if (bytes_received < 0) {
-        if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            std::cerr << "recv error on fd " << fd << "\n";
-            removeClient(fd); // Remove the client on critical errors
+        std::unique_lock<std::recursive_mutex> lock(_stateMutex);
+
+        // Admission control: one host must not exhaust the descriptor table.
+        unsigned int& fromIp = _connectionsPerIp[client_addr.sin_addr.s_addr];
+        if (_maxConnectionsPerIp && fromIp >= _maxConnectionsPerIp) {
+            lock.unlock();
+            static const char refusal[] = "ERROR :Too many connections from your host\r\n";
+            if (send(client_fd, refusal, sizeof(refusal) - 1, MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+                // Best effort: the connection is closed either way.
+            }
+            close(client_fd);
+            continue;
         }
-        return;
+
+        // Register the client’s socket with the event loop, watching for incoming data
+        try {
+            shard.eventLoop->addFd(client_fd, IO_READ, true);
+        } catch (const std::exception& e) {
+            if (fromIp == 0)
+                _connectionsPerIp.erase(client_addr.sin_addr.s_addr);
+            lock.unlock();
+            LOG_ERROR(e.what() << " for client");
+            close(client_fd);
+            continue;
+        }
+        ++fromIp;
+
+        // Add the new client to the server's client table and to the shard's own table
+        Client& client = _clients.add(client_fd, shard.index);
+        client.setIp(client_addr.sin_addr.s_addr);
+        client.lastActivity = shard.nowMs;
+        if (static_cast<size_t>(client_fd) >= shard.clients.size())
+            shard.clients.resize(client_fd + 1, NULL);
+        shard.clients[client_fd] = &client;
+
+        // Arm the registration timeout and the keepalive (both cancelled by removeClient()).
+        client.registrationTimer = scheduleTimer(REGISTRATION_TIMEOUT_MS,
+            [this, client_fd]() { checkRegistration(client_fd); });
+        client.keepaliveTimer = scheduleTimer(PING_INTERVAL_MS,
+            [this, client_fd]() { checkKeepalive(client_fd); });
+        lock.unlock();
+
+        // Log the successful connection with client IP and port
+        LOG_INFO("New connection from "
+                 << inet_ntoa(client_addr.sin_addr) // Convert IP to readable format
+                 << ":" << ntohs(client_addr.sin_port) // Convert port to host byte order
+                 << " (fd: " << client_fd << ", shard: " << shard.index << ")");
     }
+}
 
-    // Log incoming data (useful for debugging)
-    std::cout << "[INFO] Received from fd " << fd << ": "
-              << std::string(buffer, bytes_received) << "\n";
+/**
+ * @brief Accepts one pending connection and closes it at once.
+ *
+ * On `EMFILE` the pending connection cannot be accepted, so the listening
+ * socket would stay readable and the loop would spin. Closing the spare
+ * descriptor frees one slot to accept the connection and close it, after
+ * which the spare is taken again.
+ *
+ * @param shard The accepting shard.
+ * @return `true` if a connection was shed, `false` if there was none to shed
+ * or no spare descriptor to release.
+ */
+bool Server::shedConnection(Shard& shard)
+{
+    if (shard.spareFd < 0) {
+        shard.spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        return false;
+    }
 
-    // Append received data to the client's input buffer
-    getClients()[fd]->buffer.append(buffer, bytes_received);
+    close(shard.spareFd);
+    int fd = accept4(shard.listenFd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd >= 0)
+        close(fd);
+    shard.spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
 
-    std::cout << "[INFO] Buffer for fd " << fd << ": \""
-              << getClients()[fd]->buffer << "\"\n";
+    LOG_WARN("Out of file descriptors: connection refused (shard " << shard.index << ")");
+    return true;
+}
 
-    size_t pos;
+/**
+ * @brief Sets how many simultaneous connections one IP address may hold.
+ *
+ * @param limit The maximum per address, or 0 for no limit.
+ */
+void Server::setMaxConnectionsPerIp(unsigned int limit)
+{
+    _maxConnectionsPerIp = limit;
+}
 
-    // Process complete commands in the buffer
-    while (true) {
-        // Look for a complete command ending with "\r\n" or "\n"
-        pos = getClients()[fd]->buffer.find("\r\n");
-        if (pos == std::string::npos) {
-            pos = getClients()[fd]->buffer.find("\n");
-            if (pos != std::string::npos && pos > 0 && getClients()[fd]->buffer[pos - 1] == '\r') {
-                pos -= 1;
+/**
+ * @brief Sets the channel size from which deliveries are spread over all shards.
+ *
+ * @param members The threshold, or 0 to never spread deliveries.
+ */
+void Server::setFanoutThreshold(size_t members)
+{
+    _fanoutThreshold = members;
+}
+
+/**
+ * @brief Sets how many targets one PRIVMSG or NOTICE may name.
+ *
+ * @param targets The limit; 0 is raised to 1.
+ */
+void Server::setMaxTargets(unsigned int targets)
+{
+    _maxTargets = targets ? targets : 1;
+}
+
+unsigned int Server::getMaxTargets() const
+{
+    return _maxTargets;
+}
+
+/**
+ * @brief Handles incoming data from a client.
+ *
+ * This function performs the following steps:
+ * 1. Reads data from the client socket in a **non-blocking** manner, straight
+ *    into the client's input buffer, repeating until the socket is drained
+ *    (required by edge-triggered event loops) or the client has used its
+ *    `READ_BUDGET` for this pass. A client with data left over is put on the
+ *    shard's `pendingRead` list and served again on the next pass, after the
+ *    other ready clients, so one flooding client cannot starve them.
+ * 2. The function then extracts the **complete commands** (terminated by
+ *    "\r\n" or "\n") with `InputBuffer::nextLine()`, which hands out views
+ *    into the buffer and resumes scanning where it stopped, so lines are
+ *    never copied or searched twice.
+ * 3. Each command is **trimmed** and passed to `processCommand()` with
+ *    `_stateMutex` held.
+ * 4. If the client **disconnects** (recv returns 0), it is removed from the server.
+ *
+ * @param fd File descriptor of the client.
+ */
+void Server::handleClientData(int fd)
+{
+    Shard& shard = *s_currentShard;
+    Client* client = ownedClient(shard, fd);
+
+    // Edge-triggered backends report new data only once, so keep reading
+    // until the socket is drained (EAGAIN), the peer goes away, or the budget is spent.
+    size_t budget = READ_BUDGET;
+    bool drained = false;
+    bool closed = false;
+    while (budget > 0) {
+        size_t requested = client->buffer.readSize();
+        char* target = client->buffer.prepare(requested);
+        ssize_t bytes_received = recv(fd, target, requested, 0);
+
+        // If an error occurs while receiving data
+        if (bytes_received < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_WARN("recv error on fd " << fd << ": " << std::strerror(errno));
+                std::lock_guard<std::recursive_mutex> lock(_stateMutex);
+                removeClient(fd); // Remove the client on critical errors
+                return;
             }
+            drained = true;
+            break;
         }
 
-        // If no complete command is found, exit the loop
-        if (pos == std::string::npos)
+        // The peer closed the connection: process what it sent before leaving.
+        if (bytes_received == 0) {
+            closed = true;
             break;
+        }
 
-        // Extract the command from the buffer
-        std::string command = getClients()[fd]->buffer.substr(0, pos);
+        client->buffer.commit(bytes_received);
+        client->buffer.adaptReadSize(requested, bytes_received);
+        budget -= std::min(budget, static_cast<size_t>(bytes_received));
 
-        // Remove the processed command from the buffer
-        if (getClients()[fd]->buffer.substr(pos, 2) == "\r\n")
-            getClients()[fd]->buffer.erase(0, pos + 2);
-        else
-            getClients()[fd]->buffer.erase(0, pos + 1);
+        // Any traffic proves the client is alive; the keepalive timer reads this lazily.
+        client->lastActivity = shard.nowMs;
+        client->awaitingPong = false;
+    }
 
+    // Process complete commands in the buffer, framed in place.
+    std::string_view command;
+    while (client->buffer.nextLine(command)) {
         // Trim whitespace from the command
-        command.erase(0, command.find_first_not_of(" \t"));
-        command.erase(command.find_last_not_of(" \t") + 1);
+        size_t first = command.find_first_not_of(" \t");
+        if (first == std::string_view::npos)
+            continue; // Blank line: nothing to do.
+        command.remove_prefix(first);
+        command.remove_suffix(command.size() - command.find_last_not_of(" \t") - 1);
 
         // Log the extracted command
-        std::cout << "[INFO] Processing command from fd " << fd << ": \""
-                  << command << "\"\n";
+        LOG_DEBUG("Processing command from fd " << fd << ": \"" << command << "\"");
 
-        // Execute the command if it's not empty
-        if (!command.empty())
+        // Execute the command
+        {
+            std::lock_guard<std::recursive_mutex> lock(_stateMutex);
             processCommand(fd, command);
+        }
 
         // If the client was removed during command processing, stop further processing
-        if (getClients().find(fd) == getClients().end())
+        if (!ownedClient(shard, fd))
             return;
     }
 
     // Handle client disconnection
-    if (bytes_received == 0) {
-        std::cout << "Client (fd: " << fd << ") disconnected\n";
+    if (closed) {
+        LOG_INFO("Client (fd: " << fd << ") disconnected");
+        std::lock_guard<std::recursive_mutex> lock(_stateMutex);
         removeClient(fd);
+        return;
     }
+
+    // Budget spent with data still waiting: come back on the next pass.
+    if (!drained && !client->readPending) {
+        client->readPending = true;
+        shard.pendingRead.push_back(fd);
+    }
+    client->buffer.shrink();
+}
+
+/**
+ * @brief Removes a client from the server.
+ *
+ * Removal is deferred to the end of the current loop pass: the client is
+ * dropped from its shard's table and the nickname index right away, so no
+ * further input is read from it and nothing more is written to it, and its fd
+ * is queued for
+ * `closeRemovedClients()`. Handlers that are iterating over channel members
+ * or ready events therefore never see the containers change under them, and
+ * a burst of disconnects is torn down as one batch.
+ *
+ * Runs with `_stateMutex` held, on the thread of the shard owning the client.
+ * Removing a client twice is harmless.
+ *
+ * @param fd File descriptor of the client to be removed.
+ */
+void Server::removeClient(int fd)
+{
+    Client* client = _clients[fd];
+    if (!client)
+        return;
+    Shard& shard = *_shards[client->getShard()];
+    if (!ownedClient(shard, fd))
+        return; // Already queued for closing.
+
+    shard.clients[fd] = NULL;
+    shard.closing.push_back(fd);
+
+    // Free the nickname at once: the client can no longer be addressed by it.
+    const std::string& nick = client->getNickname();
+    if (!nick.empty())
+        _nicknames.erase(Utils::casefold(nick));
 }
 
 /**
- * @brief Removes a client from the server and cleans up associated resources.
+ * @brief Closes the clients removed during this loop pass and cleans up associated resources.
  *
- * This function ensures proper cleanup when a client disconnects or is forcibly removed.
- * It performs the following steps:
+ * It performs the following steps, once per pass for the whole batch:
  *
- * 1. **Remove the client from all channels**:
- *    - Iterates over the server's channel list and removes the client from each.
- *    - If a channel becomes empty after removal, it is deleted from the `_channels` map.
+ * 1. For each client, **leave its channels**: only the channels recorded on
+ *    the client are touched (membership and operator status); channels left
+ *    empty are deleted from the `_channels` map.
  *
- * 2. **Close the client's socket** to free system resources.
+ * 2. **Cancel its timers**, make a last non-blocking attempt to send what is
+ *    left in its `outBuffer` (e.g. an `ERROR` line), **unregister its
+ *    descriptor** from the event loop and **close** it.
  *
- * 3. **Remove the client from the server's client map** to ensure no stale references exist.
+ * 3. **Remove the clients from the server's client table**, which retires
+ *    their `ClientId`s.
  *
- * 4. **Remove the client's file descriptor from the poll descriptor vector** to prevent unnecessary polling.
+ * Invitations and file transfers refer to clients by `ClientId`, so they are
+ * not scrubbed here: a retired handle never matches a later connection on the
+ * same descriptor. Stale invitations are pruned by `inviteToChannel()`, and
+ * transfers of a departed sender expire on their idle timer. The cost is
+ * linear in the channels the removed clients were on.
  *
- * @param fd File descriptor of the client to be removed.
+ * @param shard The calling shard.
  */
-void Server::removeClient(int fd)
+void Server::closeRemovedClients(Shard& shard)
 {
-    // Iterate through all channels and remove the client from them
-    for (std::map<std::string, Channel>::iterator it = _channels.begin();
-        it != _channels.end(); ++it) {
-        it->second.removeInvite(fd);
-    }
-    for (std::map<std::string, Channel>::iterator it = _channels.begin();
-        it != _channels.end();) {
-        it->second.removeClient(fd); // Remove client from this channel
+    if (shard.closing.empty())
+        return;
 
-        // If the channel is now empty, erase it from the server
-        if (it->second.getClients().empty()) {
-            std::map<std::string, Channel>::iterator eraseIt = it++;
-            _channels.erase(eraseIt);
-        } else {
-            ++it;
-        }
-    }
+    std::lock_guard<std::recursive_mutex> lock(_stateMutex);
 
-    close(fd);
+    for (size_t i = 0; i < shard.closing.size(); ++i) {
+        int fd = shard.closing[i];
 
-    // Remove the client from the server's client map
-    getClients().erase(fd);
-    // Remove the client's file descriptor from the poll descriptor vector
-    for (size_t i = 0; i < _poll_fds.size(); ++i) {
-        if (_poll_fds[i].fd == fd) {
-            _poll_fds.erase(_poll_fds.begin() + i);
-            break;
+        Client* client = _clients[fd];
+        if (!client)
+            continue;
+
+        // Leave the client's own channels (erasing those left empty)
+        while (!client->channels.empty())
+            leaveChannel(fd, *client->channels.begin());
+
+        shard.timers.cancel(client->registrationTimer);
+        shard.timers.cancel(client->keepaliveTimer);
+        shard.listings.erase(fd);
+
+        // Last chance for queued output (best effort, never blocks)
+        if (!client->outBuffer.empty() && client->outBuffer.writeTo(fd) < 0) {
+            // The peer is gone or not reading: nothing more to do.
         }
+
+        // Stop watching the descriptor before closing it
+        shard.eventLoop->removeFd(fd);
+        close(fd);
+
+        // Release its share of the per-IP limit
+        std::map<uint32_t, unsigned int>::iterator ipIt = _connectionsPerIp.find(client->getIp());
+        if (ipIt != _connectionsPerIp.end() && --ipIt->second == 0)
+            _connectionsPerIp.erase(ipIt);
+
+        // Remove the client from the server's client table
+        _clients.remove(fd);
     }
+    shard.closing.clear();
 }
 
 /**
@@ -520,10 +1172,12 @@ void Server::removeClient(int fd)
 //!
 void Server::broadcastMessage(const std::string& message, int sender_fd)
 {
-    for (const auto& pair : getClients()) {
-        int client_fd = pair.first;
+    SharedMessage shared = std::make_shared<const std::string>(message);
+    const std::vector<int>& fds = _clients.fds();
+    for (size_t i = 0; i < fds.size(); ++i) {
+        int client_fd = fds[i];
         if (client_fd != sender_fd) {
-            safeSend(client_fd, message);
+            safeSend(client_fd, shared);
         }
     }
 }
@@ -532,112 +1186,45 @@ void Server::broadcastMessage(const std::string& message, int sender_fd)
 /**
  * @brief Processes a complete command received from a client.
  *
- * Splits the command string into tokens and dispatches it to the appropriate
- * command handler based on the first token.
+ * Parses the line in place into an `IrcMessage` (views, no copies), looks
+ * its verb up in the dispatch table, enforces the command's registration
+ * and parameter requirements, then calls its handler.
  *
  * @param fd File descriptor of the client that sent the command.
- * @param command The complete command string.
+ * @param line The complete command line, viewed in the client's input buffer.
  */
-void Server::processCommand(int fd, const std::string& command)
+void Server::processCommand(int fd, std::string_view line)
 {
-    // std::cout << Utils::getTimestamp() << "Command from fd " << fd << ": " <<
-    // command << std::endl;
-    std::cout << "\033[1;32m" << Utils::getTimestamp() << "Command from fd "
-              << fd << ": " << command << "\033[0m" << std::endl;
-    std::vector<std::string> tokens = Utils::split(command, ' ');
-    if (tokens.empty())
+    IrcMessage msg;
+    if (!msg.parse(line))
         return;
 
-    std::string cmd = tokens[0];
-    std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::toupper);
+    const CommandSpec* spec = findCommand(msg.command);
+    if (!spec) {
+        std::string verb(msg.command);
+        std::transform(verb.begin(), verb.end(), verb.begin(), ::toupper);
+        Reply(this, fd, ERR_UNKNOWNCOMMAND).param(verb).send();
+        return;
+    }
 
-    if (cmd == "PASS") {
-        if (getClients()[fd]->authState != NOT_REGISTERED) {
-            mayNotRegistered(fd);
-            return;
-        }
-        handlePassCommand(this, fd, tokens, command);
-    } else if (cmd == "NICK") {
-        if (!_password.empty() && getClients()[fd]->authState == NOT_REGISTERED) {
-            passRequired(fd);
-            return;
-        }
-        handleNickCommand(this, fd, tokens, command);
-    } else if (cmd == "USER") {
-        if (!_password.empty() && getClients()[fd]->authState == NOT_REGISTERED) {
-            passRequired(fd);
-            return;
-        }
-        handleUserCommand(this, fd, tokens, command);
-    } else if (cmd == "JOIN") {
-        if (getClients()[fd]->authState != AUTH_REGISTERED) {
-            notRegistered(fd);
-            return;
-        }
-        handleJoinCommand(this, fd, tokens, command);
-    } else if (cmd == "PRIVMSG") {
-        if (getClients()[fd]->authState != AUTH_REGISTERED) {
-            notRegistered(fd);
-            return;
-        }
-        handlePrivmsgCommand(this, fd, tokens, command);
-    } else if (cmd == "QUIT") {
-        handleQuitCommand(this, fd, tokens, command);
-    } else if (cmd == "PART") {
-        if (getClients()[fd]->authState != AUTH_REGISTERED) {
+    // Without a server password the PASS step counts as done.
+    AuthState state = getClients()[fd]->authState;
+    if (state == NOT_REGISTERED && _password.empty())
+        state = WAITING_FOR_NICK;
+    if (state < spec->minState) {
+        if (spec->minState == AUTH_REGISTERED)
             notRegistered(fd);
-            return;
-        }
-        handlePartCommand(this, fd, tokens, command);
-    } else if (cmd == "KICK") {
-        if (getClients()[fd]->authState != AUTH_REGISTERED) {
-            notRegistered(fd);
-            return;
-        }
-        handleKickCommand(this, fd, tokens, command);
-    } else if (cmd == "INVITE") {
-        if (getClients()[fd]->authState != AUTH_REGISTERED) {
-            notRegistered(fd);
-            return;
-        }
-        handleInviteCommand(this, fd, tokens, command);
-    } else if (cmd == "TOPIC") {
-        if (getClients()[fd]->authState != AUTH_REGISTERED) {
-            notRegistered(fd);
-            return;
-        }
-        handleTopicCommand(this, fd, tokens, command);
-    } else if (cmd == "MODE") {
-        if (getClients()[fd]->authState != AUTH_REGISTERED) {
-            notRegistered(fd);
-            return;
-        }
-        handleModeCommand(this, fd, tokens, command);
-    } else if (cmd == "FILE") {
-        handleFileCommand(this, fd, tokens, command);
-    } else if (cmd == "BOT") {
-        handleBotCommand(this, fd, tokens, command);
-    } else if (cmd == "PING") {
-        std::string pong = "PONG ";
-        if (tokens.size() > 1)
-            pong += tokens[1];
-        pong += "\r\n";
-        send(fd, pong.c_str(), pong.size(), 0);
-        std::cout << "Sending: " << pong;
-    } else if (cmd == "WHO") {
-        handleWhoCommand(this, fd, tokens, command);
-    } else if (cmd == "WHOIS") {
-        handleWhoisCommand(this, fd, tokens, command);
-    } else if (cmd == "LIST") {
-        handleListCommand(this, fd, tokens, command);
-    } else if (cmd == "CAP") {
-        handleCapCommand(this, fd, tokens, command);
-    }
-
-    else {
-        std::string reply = "421 " + cmd + " :Unknown command\r\n";
-        send(fd, reply.c_str(), reply.size(), 0);
+        else
+            passRequired(fd);
+        return;
     }
+
+    if (msg.paramCount < spec->minParams) {
+        Reply(this, fd, ERR_NEEDMOREPARAMS).param(spec->name).send();
+        return;
+    }
+
+    spec->handler(this, fd, msg);
 }
 
 /**
@@ -663,9 +1250,9 @@ void Server::setPassword(const std::string& newPassword)
 /**
  * @brief Retrieves the list of connected clients.
  *
- * @return A reference to the map of clients (key: file descriptor).
+ * @return A reference to the table of clients (indexed by file descriptor).
  */
-std::map<int, std::unique_ptr<Client>>& Server::getClients()
+ClientTable& Server::getClients()
 {
     return _clients;
 }
@@ -700,6 +1287,388 @@ const std::string& Server::getServerName() const
     return _serverName;
 }
 
+/**
+ * @brief Looks a nickname up in the casefolded nickname index.
+ *
+ * @param nickname The nickname to look up.
+ * @return The file descriptor of its client, or -1.
+ */
+int Server::findClientByNick(std::string_view nickname) const
+{
+    std::unordered_map<std::string, int>::const_iterator it = _nicknames.find(Utils::casefold(nickname));
+    return it != _nicknames.end() ? it->second : -1;
+}
+
+/**
+ * @brief Renames a client, moving its entry in the nickname index.
+ *
+ * A client may change the case of its own nickname.
+ *
+ * @param fd The file descriptor of the client.
+ * @param nickname The new nickname.
+ * @return `false` if the nickname belongs to another client.
+ */
+bool Server::setClientNickname(int fd, const std::string& nickname)
+{
+    std::string key = Utils::casefold(nickname);
+    std::unordered_map<std::string, int>::iterator it = _nicknames.find(key);
+    if (it != _nicknames.end() && it->second != fd)
+        return false;
+
+    Client* client = _clients[fd];
+    if (!client->getNickname().empty())
+        _nicknames.erase(Utils::casefold(client->getNickname()));
+    _nicknames[key] = fd;
+    client->setNickname(nickname);
+
+    // The nickname is part of each of its channels' NAMES list.
+    for (std::set<std::string>::const_iterator it = client->channels.begin();
+        it != client->channels.end(); ++it) {
+        std::map<std::string, Channel>::iterator chan = _channels.find(*it);
+        if (chan != _channels.end())
+            chan->second.invalidateNames();
+    }
+    return true;
+}
+
+/**
+ * @brief Adds a client to a channel, keeping the client's channel set in sync.
+ *
+ * @param fd The file descriptor of the client.
+ * @param channel The channel to join.
+ */
+void Server::joinChannel(int fd, Channel& channel)
+{
+    Client* client = _clients[fd];
+    channel.addClient(client->getId(), client->getNickname());
+    client->channels.insert(channel.getName());
+    channel.removeInvite(client->getId());
+}
+
+/**
+ * @brief Removes a client from a channel and erases the channel if it is left empty.
+ *
+ * The name is a copy: erasing it from `client->channels` (or erasing the
+ * channel) may free the string the caller passed.
+ *
+ * @param fd The file descriptor of the client.
+ * @param channelName The name of the channel.
+ */
+void Server::leaveChannel(int fd, std::string channelName)
+{
+    Client* client = _clients[fd];
+    client->channels.erase(channelName);
+    std::map<std::string, Channel>::iterator it = _channels.find(channelName);
+    if (it == _channels.end())
+        return;
+    it->second.removeClient(client->getId());
+    if (it->second.getClients().empty())
+        _channels.erase(it);
+}
+
+/**
+ * @brief Invites a client to a channel, pruning the channel's stale invitations.
+ *
+ * Invitations outlive the clients they were for (see `closeRemovedClients()`);
+ * they are dropped here, so a channel's invite list only grows with clients
+ * that are still connected. The pruning costs one handle check per invitation
+ * of this channel.
+ *
+ * @param fd The file descriptor of the invited client.
+ * @param channel The channel.
+ */
+void Server::inviteToChannel(int fd, Channel& channel)
+{
+    std::vector<ClientId> stale;
+    const std::set<ClientId>& invites = channel.getInvites();
+    for (std::set<ClientId>::const_iterator it = invites.begin(); it != invites.end(); ++it) {
+        if (!_clients.find(*it))
+            stale.push_back(*it);
+    }
+    for (size_t i = 0; i < stale.size(); ++i)
+        channel.removeInvite(stale[i]);
+    channel.inviteClient(_clients[fd]->getId());
+}
+
+/**
+ * @brief Queues a message for the client a handle refers to, if it is still connected.
+ *
+ * @param id The handle of the client.
+ * @param message The message to be sent.
+ */
+void Server::sendTo(ClientId id, const std::string& message)
+{
+    if (_clients.find(id))
+        safeSend(ClientTable::fdOf(id), message);
+}
+
+/**
+ * @brief Sends a message to every member of a channel, spreading big channels over all shards.
+ *
+ * A big delivery posts each shard the list of the members it owns (see
+ * `postToMembers()`); each shard's thread then queues the message for them
+ * while the calling loop moves on. Ordering holds because every message for
+ * a client goes through its owner's mailbox (FIFO) or, from the owner
+ * itself, is queued only after that mailbox is drained (see `safeSend()`).
+ *
+ * @param channel The channel.
+ * @param message The message to be sent.
+ * @param except A member who does not receive it (0 for none).
+ */
+void Server::sendToChannel(Channel& channel, const SharedMessage& message, ClientId except)
+{
+    if (spreadsOverShards(channel)) {
+        postToMembers(channel, message, except, 0);
+        return;
+    }
+
+    const std::vector<ClientId>& members = channel.getClients();
+    for (size_t i = 0; i < members.size(); ++i) {
+        if (members[i] != except)
+            sendTo(members[i], message);
+    }
+}
+
+bool Server::spreadsOverShards(const Channel& channel) const
+{
+    return _shards.size() > 1 && _fanoutThreshold && channel.getClients().size() >= _fanoutThreshold;
+}
+
+/**
+ * @brief Posts each shard the channel members it owns, along with the message.
+ *
+ * The members are grouped by owner once, by their descriptor's entry in
+ * `ClientTable::shardOf()`, and the lists are cached in the channel until
+ * someone joins or leaves. Each shard thus walks only its own recipients,
+ * and a further message to the same channel costs the calling loop one mail
+ * per shard, with nothing copied.
+ *
+ * @param channel The channel.
+ * @param message The message to be sent.
+ * @param except A member who does not receive it (0 for none).
+ * @param epoch A deduplicated delivery, or 0.
+ */
+void Server::postToMembers(Channel& channel, const SharedMessage& message, ClientId except, uint64_t epoch)
+{
+    if (!channel.getMembersByShard()) {
+        std::vector<std::vector<ClientId>> owned(_shards.size());
+        const std::vector<ClientId>& members = channel.getClients();
+        for (size_t i = 0; i < members.size(); ++i)
+            owned[_clients.shardOf(ClientTable::fdOf(members[i]))].push_back(members[i]);
+
+        std::vector<MemberList> byShard(_shards.size());
+        for (size_t i = 0; i < owned.size(); ++i)
+            byShard[i] = std::make_shared<const std::vector<ClientId>>(std::move(owned[i]));
+        channel.setMembersByShard(std::move(byShard));
+    }
+
+    const std::vector<MemberList>& byShard = *channel.getMembersByShard();
+    for (size_t i = 0; i < byShard.size(); ++i) {
+        if (!byShard[i]->empty())
+            postToShard(*_shards[i], Mail(byShard[i], message, except, epoch));
+    }
+}
+
+/**
+ * @brief Sends a message once to every client that shares a channel with `fd`.
+ *
+ * Each call starts a new epoch and stamps every client it reaches with it, the
+ * source first, so a client met again on another channel is recognised by its
+ * stamp. Deduplication allocates nothing and costs one check per membership
+ * of the client's channels.
+ *
+ * Channels past the fan-out threshold are posted to the shards, as in
+ * `sendToChannel()`, under the same epoch: a shard reaching a client through
+ * two of them queues the message once. Members of the small channels who are
+ * also on one of the big ones are left to the shards.
+ *
+ * @param fd The file descriptor of the client the notification is about.
+ * @param message The message to be sent.
+ */
+void Server::notifyChannelPeers(int fd, const SharedMessage& message)
+{
+    Client* client = _clients[fd];
+    if (!client)
+        return;
+
+    uint64_t epoch = newNotifyEpoch();
+    client->notifyEpoch = epoch;
+
+    std::vector<const Channel*> spread;
+    for (std::set<std::string>::const_iterator it = client->channels.begin();
+        it != client->channels.end(); ++it) {
+        std::map<std::string, Channel>::iterator chanIt = _channels.find(*it);
+        if (chanIt != _channels.end() && spreadOnce(chanIt->second, message, client->getId(), epoch))
+            spread.push_back(&chanIt->second);
+    }
+
+    for (std::set<std::string>::const_iterator it = client->channels.begin();
+        it != client->channels.end(); ++it) {
+        std::map<std::string, Channel>::const_iterator chanIt = _channels.find(*it);
+        if (chanIt == _channels.end() || spreadsOverShards(chanIt->second))
+            continue;
+
+        const std::vector<ClientId>& members = chanIt->second.getClients();
+        for (size_t i = 0; i < members.size(); ++i) {
+            bool posted = false;
+            for (size_t s = 0; s < spread.size() && !posted; ++s)
+                posted = spread[s]->hasClient(members[i]);
+            if (!posted)
+                sendOnce(members[i], message, epoch);
+        }
+    }
+}
+
+uint64_t Server::newNotifyEpoch()
+{
+    return ++_notifyEpoch;
+}
+
+/**
+ * @brief Posts a big channel's part of a deduplicated delivery to the shards.
+ *
+ * @param channel The channel.
+ * @param message The message to be sent.
+ * @param except A member who does not receive it (0 for none).
+ * @param epoch The delivery, from `newNotifyEpoch()`.
+ * @return Whether the channel was past the fan-out threshold (and posted).
+ */
+bool Server::spreadOnce(Channel& channel, const SharedMessage& message, ClientId except, uint64_t epoch)
+{
+    if (!spreadsOverShards(channel))
+        return false;
+    postToMembers(channel, message, except, epoch);
+    return true;
+}
+
+/**
+ * @brief Sends a message to a client unless its stamp shows it was reached in `epoch`.
+ *
+ * @param id The handle of the client (ignored if it has left).
+ * @param message The message to be sent.
+ * @param epoch The delivery, from `newNotifyEpoch()`.
+ * @return `true` if the message was queued.
+ */
+bool Server::sendOnce(ClientId id, const SharedMessage& message, uint64_t epoch)
+{
+    Client* client = _clients.find(id);
+    if (!client || client->notifyEpoch == epoch)
+        return false;
+    client->notifyEpoch = epoch;
+    safeSend(client->getFd(), message);
+    return true;
+}
+
+/**
+ * @brief Registers a client's LIST on its shard and sends the first batch.
+ *
+ * A LIST still in progress is cut short first, with a notice and its own
+ * 323, so that every LIST gets exactly one end-of-list reply.
+ *
+ * @param fd The file descriptor of the client.
+ * @param query The filters, positioned at the start.
+ */
+void Server::startList(int fd, const ListQuery& query)
+{
+    Client* client = _clients[fd];
+    if (!client)
+        return;
+    Shard& shard = *_shards[client->getShard()];
+    if (shard.listings.count(fd)) {
+        Reply(this, fd, SERVER_NOTICE).text("LIST aborted").send();
+        Reply(this, fd, RPL_LISTEND).send();
+    }
+    ListQuery& listing = shard.listings[fd] = query;
+    if (continueList(shard, fd, listing))
+        shard.listings.erase(fd);
+}
+
+/**
+ * @brief Sends 322 replies for the next channels of a LIST.
+ *
+ * Walks the channel map from the query's position, and stops after
+ * `LIST_SCAN_BATCH` channels or once the client has `LIST_OUTPUT_LIMIT` bytes
+ * queued, recording the next channel to examine. Reaching the end of the map
+ * sends the 323.
+ */
+bool Server::continueList(Shard& shard, int fd, ListQuery& query)
+{
+    Client* client = ownedClient(shard, fd);
+    if (!client)
+        return true;
+
+    std::map<std::string, Channel>::const_iterator it = _channels.lower_bound(query.getPosition());
+    for (size_t scanned = 0; it != _channels.end(); ++it, ++scanned) {
+        if (scanned == LIST_SCAN_BATCH || client->outBuffer.size() >= LIST_OUTPUT_LIMIT) {
+            query.setPosition(it->first);
+            return false;
+        }
+        const Channel& channel = it->second;
+        if (query.matches(channel))
+            Reply(this, fd, RPL_LIST).param(channel.getName())
+                .param(channel.getClients().size()).text(channel.getTopic()).send();
+    }
+    Reply(this, fd, RPL_LISTEND).send();
+    return true;
+}
+
+/**
+ * @brief Gives every LIST in progress on the shard one more batch.
+ *
+ * A client whose socket is full (`writeWatched`) or whose queue is still long
+ * is skipped: it is resumed on a later pass, once its socket drained.
+ *
+ * @param shard The calling shard.
+ */
+void Server::serveListings(Shard& shard)
+{
+    if (shard.listings.empty())
+        return;
+
+    std::lock_guard<std::recursive_mutex> lock(_stateMutex);
+    std::map<int, ListQuery>::iterator it = shard.listings.begin();
+    while (it != shard.listings.end()) {
+        Client* client = ownedClient(shard, it->first);
+        if (client && (client->writeWatched || client->outBuffer.size() >= LIST_OUTPUT_LIMIT)) {
+            ++it;
+            continue;
+        }
+        if (continueList(shard, it->first, it->second))
+            it = shard.listings.erase(it);
+        else
+            ++it;
+    }
+}
+
+/**
+ * @brief Tells the loop whether to poll without sleeping for a pending LIST.
+ *
+ * Only listings that can make progress count, so a client that does not
+ * read its replies makes the loop wait for its socket, not spin.
+ */
+bool Server::hasListingToServe(const Shard& shard) const
+{
+    for (std::map<int, ListQuery>::const_iterator it = shard.listings.begin();
+        it != shard.listings.end(); ++it) {
+        Client* client = ownedClient(shard, it->first);
+        if (!client || (!client->writeWatched && client->outBuffer.size() < LIST_OUTPUT_LIMIT))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Queues a shared message for the client a handle refers to, by reference.
+ *
+ * @param id The handle of the client.
+ * @param message The message to be sent.
+ */
+void Server::sendTo(ClientId id, const SharedMessage& message)
+{
+    if (_clients.find(id))
+        safeSend(ClientTable::fdOf(id), message);
+}
+
 /**
  * @brief Prevents clients from re-registering if already authenticated.
  *
@@ -712,8 +1681,7 @@ const std::string& Server::getServerName() const
 void Server::mayNotRegistered(int fd)
 {
     if (!_password.empty() && getClients()[fd]->authState == NOT_REGISTERED) {
-        std::string reply = "462 :You may not reregister\r\n";
-        safeSend(fd, reply);
+        Reply(this, fd, ERR_ALREADYREGISTRED).send();
     }
 }
 
@@ -727,7 +1695,7 @@ void Server::mayNotRegistered(int fd)
  */
 void Server::passRequired(int fd)
 {
-    safeSend(fd, "464 :Password required\r\n");
+    Reply(this, fd, ERR_PASSWDMISMATCH).text("Password required").send();
     removeClient(fd);
 }
 
@@ -740,5 +1708,5 @@ void Server::passRequired(int fd)
  */
 void Server::notRegistered(int fd)
 {
-    safeSend(fd, "451 :You have not registered\r\n");
+    Reply(this, fd, ERR_NOTREGISTERED).send();
 }
@@ -0,0 +1,286 @@
+#include "../include/TimerWheel.hpp"
+#include <chrono>
+#include <climits>
+
+// Largest distance a single placement can represent; farther deadlines take extra laps.
+static const uint64_t MAX_DELTA = (static_cast<uint64_t>(1) << (6 * 4)) - 1;
+
+/**
+ * @brief Rotates a 64-bit bitmap right, so that bit `shift` becomes bit 0.
+ */
+static inline uint64_t rotateRight(uint64_t bits, unsigned int shift)
+{
+    shift &= 63;
+    return shift ? (bits >> shift) | (bits << (64 - shift)) : bits;
+}
+
+/**
+ * @brief Creates an empty wheel whose first tick is the one containing `nowMs`.
+ */
+TimerWheel::TimerWheel(uint64_t nowMs, unsigned int tickMs)
+    : _tickMs(tickMs ? tickMs : 1)
+    , _nowMs(nowMs)
+    , _tick(nowMs / _tickMs)
+    , _count(0)
+    , _nodes()
+    , _freeList(NIL)
+{
+    for (unsigned int i = 0; i <= EXPIRED_LIST; ++i) {
+        _heads[i] = NIL;
+        _tails[i] = NIL;
+    }
+    for (unsigned int i = 0; i < LEVELS; ++i)
+        _occupied[i] = 0;
+}
+
+uint64_t TimerWheel::now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+size_t TimerWheel::size() const
+{
+    return _count;
+}
+
+/**
+ * @brief Appends a node to a list (slot lists keep FIFO order for equal deadlines).
+ */
+void TimerWheel::link(uint32_t index, uint32_t list)
+{
+    Node& node = _nodes[index];
+    node.list = list;
+    node.next = NIL;
+    node.prev = _tails[list];
+    if (_tails[list] != NIL)
+        _nodes[_tails[list]].next = index;
+    else
+        _heads[list] = index;
+    _tails[list] = index;
+    if (list < EXPIRED_LIST)
+        _occupied[list / SLOTS] |= static_cast<uint64_t>(1) << (list % SLOTS);
+}
+
+void TimerWheel::unlink(uint32_t index)
+{
+    Node& node = _nodes[index];
+    uint32_t list = node.list;
+    if (node.prev != NIL)
+        _nodes[node.prev].next = node.next;
+    else
+        _heads[list] = node.next;
+    if (node.next != NIL)
+        _nodes[node.next].prev = node.prev;
+    else
+        _tails[list] = node.prev;
+    node.list = NIL;
+    if (_heads[list] == NIL && list < EXPIRED_LIST)
+        _occupied[list / SLOTS] &= ~(static_cast<uint64_t>(1) << (list % SLOTS));
+}
+
+void TimerWheel::release(uint32_t index)
+{
+    Node& node = _nodes[index];
+    node.callback = Callback();
+    node.list = NIL;
+    if (++node.generation == 0)
+        node.generation = 1; // Keep handles non-zero.
+    node.next = _freeList;
+    _freeList = index;
+    --_count;
+}
+
+/**
+ * @brief Picks the level from the distance to the deadline and the slot from
+ * the deadline itself, so that timers due in the same period share a slot.
+ */
+void TimerWheel::place(uint32_t index)
+{
+    // Deadlines beyond the wheel's span wait in the farthest slot and are
+    // re-placed from there, so they never fire early.
+    uint64_t expiry = _nodes[index].expiry;
+    uint64_t delta = expiry - _tick;
+    if (delta > MAX_DELTA) {
+        delta = MAX_DELTA;
+        expiry = _tick + MAX_DELTA;
+    }
+
+    unsigned int level = 0;
+    while (level + 1 < LEVELS && delta >= (static_cast<uint64_t>(1) << (SLOT_BITS * (level + 1))))
+        ++level;
+    unsigned int slot = static_cast<unsigned int>(expiry >> (SLOT_BITS * level)) & (SLOTS - 1);
+    link(index, level * SLOTS + slot);
+}
+
+TimerId TimerWheel::schedule(uint64_t delayMs, const Callback& callback)
+{
+    // Round up, so that a timer never fires before its delay has elapsed.
+    uint64_t expiry = (_nowMs + delayMs + _tickMs - 1) / _tickMs;
+    if (expiry < _tick)
+        expiry = _tick;
+
+    uint32_t index;
+    if (_freeList != NIL) {
+        index = _freeList;
+        _freeList = _nodes[index].next;
+    } else {
+        index = static_cast<uint32_t>(_nodes.size());
+        Node fresh;
+        fresh.expiry = 0;
+        fresh.prev = NIL;
+        fresh.next = NIL;
+        fresh.list = NIL;
+        fresh.generation = 1;
+        _nodes.push_back(fresh);
+    }
+
+    Node& node = _nodes[index];
+    node.expiry = expiry;
+    node.callback = callback;
+    place(index);
+    ++_count;
+    return (static_cast<TimerId>(node.generation) << 32) | index;
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+    uint32_t index = static_cast<uint32_t>(id);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (id == 0 || index >= _nodes.size())
+        return false;
+    if (_nodes[index].list == NIL || _nodes[index].generation != generation)
+        return false; // Already fired, cancelled, or reused.
+    unlink(index);
+    release(index);
+    return true;
+}
+
+void TimerWheel::cascade(unsigned int level, unsigned int slot)
+{
+    uint32_t list = level * SLOTS + slot;
+    uint32_t index = _heads[list];
+    _heads[list] = NIL;
+    _tails[list] = NIL;
+    _occupied[level] &= ~(static_cast<uint64_t>(1) << slot);
+
+    while (index != NIL) {
+        uint32_t next = _nodes[index].next;
+        place(index);
+        index = next;
+    }
+}
+
+/**
+ * @brief Processes one tick.
+ *
+ * The due slot is moved to the expired list and the tick is consumed before
+ * any callback runs: a callback scheduling a zero-delay timer then gets the
+ * next tick, and one cancelling a sibling simply unlinks it from that list.
+ */
+void TimerWheel::runTick()
+{
+    for (unsigned int level = 1; level < LEVELS; ++level) {
+        if (_tick & ((static_cast<uint64_t>(1) << (SLOT_BITS * level)) - 1))
+            break;
+        cascade(level, static_cast<unsigned int>(_tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    }
+
+    // Consume the tick, then sort the slot: clamped timers go back on the wheel.
+    uint32_t list = static_cast<uint32_t>(_tick) & (SLOTS - 1);
+    uint32_t index = _heads[list];
+    _heads[list] = NIL;
+    _tails[list] = NIL;
+    _occupied[0] &= ~(static_cast<uint64_t>(1) << list);
+    uint64_t tick = _tick++;
+    while (index != NIL) {
+        uint32_t next = _nodes[index].next;
+        if (_nodes[index].expiry > tick)
+            place(index);
+        else
+            link(index, EXPIRED_LIST);
+        index = next;
+    }
+
+    while (_heads[EXPIRED_LIST] != NIL) {
+        index = _heads[EXPIRED_LIST];
+        unlink(index);
+        Callback callback;
+        callback.swap(_nodes[index].callback);
+        release(index);
+        callback();
+    }
+}
+
+/**
+ * @brief Returns the distance in ticks to the next tick with work to do.
+ *
+ * For level 0 that is the next occupied slot; for higher levels it is the tick
+ * at which the next occupied slot is cascaded.
+ */
+int64_t TimerWheel::ticksUntilNext() const
+{
+    if (_count == 0)
+        return -1;
+
+    int64_t best = -1;
+    if (_occupied[0]) {
+        unsigned int cur = static_cast<unsigned int>(_tick) & (SLOTS - 1);
+        best = __builtin_ctzll(rotateRight(_occupied[0], cur));
+    }
+
+    for (unsigned int level = 1; level < LEVELS; ++level) {
+        if (!_occupied[level])
+            continue;
+        unsigned int shift = SLOT_BITS * level;
+        uint64_t base = _tick >> shift;
+        uint64_t rotated = rotateRight(_occupied[level], static_cast<unsigned int>(base) & (SLOTS - 1));
+        bool onBoundary = (_tick & ((static_cast<uint64_t>(1) << shift) - 1)) == 0;
+
+        uint64_t offset;
+        if ((rotated & 1) && onBoundary)
+            offset = 0; // The current slot is cascaded by this very tick.
+        else if (rotated & ~static_cast<uint64_t>(1))
+            offset = __builtin_ctzll(rotated & ~static_cast<uint64_t>(1));
+        else
+            offset = SLOTS;
+
+        int64_t distance = static_cast<int64_t>(((base + offset) << shift) - _tick);
+        if (best < 0 || distance < best)
+            best = distance;
+    }
+    return best;
+}
+
+/**
+ * @brief Runs the timers due up to `nowMs`, jumping straight over empty ticks.
+ */
+void TimerWheel::advance(uint64_t nowMs)
+{
+    if (nowMs > _nowMs)
+        _nowMs = nowMs;
+    uint64_t target = _nowMs / _tickMs;
+
+    while (_tick <= target) {
+        int64_t next = ticksUntilNext();
+        if (next < 0 || _tick + static_cast<uint64_t>(next) > target) {
+            _tick = target + 1;
+            break;
+        }
+        _tick += static_cast<uint64_t>(next);
+        runTick();
+    }
+}
+
+int TimerWheel::nextTimeoutMs(uint64_t nowMs) const
+{
+    int64_t next = ticksUntilNext();
+    if (next < 0)
+        return -1;
+
+    uint64_t deadlineMs = (_tick + static_cast<uint64_t>(next)) * _tickMs;
+    if (deadlineMs <= nowMs)
+        return 0;
+    uint64_t wait = deadlineMs - nowMs;
+    return wait > static_cast<uint64_t>(INT_MAX) ? INT_MAX : static_cast<int>(wait);
+}
@@ -4,28 +4,48 @@
 #include <sstream>
 #include <string>
 
-/**
- * @brief Splits a string using a specified delimiter.
- *
- * This function takes an input string and splits it into tokens
- * using the provided delimiter character. Each token is appended to a vector of strings,
- * which is then returned.
- *
- * @param str The input string to be split.
- * @param delimiter The character used to separate tokens in the string.
- * @return std::vector<std::string> A vector containing the tokens extracted from the input string.
- */
+std::string Utils::casefold(std::string_view name)
+{
+    std::string folded(name);
+    for (size_t i = 0; i < folded.size(); ++i) {
+        char c = folded[i];
+        if (c >= 'A' && c <= '^') // 'A'-'Z' and '[', '\\', ']', '^' are 32 below their lower forms.
+            folded[i] = static_cast<char>(c + 32);
+    }
+    return folded;
+}
 
-std::vector<std::string> Utils::split(const std::string& str, char delimiter)
+/** @brief Folds one character with the RFC 1459 casemapping (see `casefold()`). */
+static char foldChar(char c)
 {
-    std::vector<std::string> tokens; // Stores parts of the input string.
-    std::stringstream ss(str);
-    std::string token;
-    // Extract tokens separated by the delimiter and add them to the tokens vector.
-    while (std::getline(ss, token, delimiter)) {
-        tokens.push_back(token);
+    return c >= 'A' && c <= '^' ? static_cast<char>(c + 32) : c;
+}
+
+bool Utils::matchMask(std::string_view mask, std::string_view name)
+{
+    size_t m = 0;
+    size_t n = 0;
+    size_t star = std::string_view::npos; // Position of the last '*' seen in the mask.
+    size_t resume = 0; // Where in `name` that '*' is retried from.
+
+    while (n < name.size()) {
+        if (m < mask.size() && mask[m] == '*') {
+            star = m++;
+            resume = n;
+        } else if (m < mask.size() && (mask[m] == '?' || foldChar(mask[m]) == foldChar(name[n]))) {
+            ++m;
+            ++n;
+        } else if (star != std::string_view::npos) {
+            // Let the last '*' swallow one more character and retry.
+            m = star + 1;
+            n = ++resume;
+        } else {
+            return false;
+        }
     }
-    return tokens;
+    while (m < mask.size() && mask[m] == '*')
+        ++m;
+    return m == mask.size();
 }
 
 std::string Utils::getTimestamp()
@@ -1,8 +1,11 @@
+#include "Logger.hpp"
 #include "Server.hpp"
 #include <csignal>
 #include <cstdlib>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 
 static void handleSignal(int signum)
 {
@@ -39,12 +42,89 @@ int main(int argc, char* argv[])
     }
     std::string password = argv[2];
 
+    // Optional backend override, e.g. IRCSERV_EVENT_LOOP=poll to compare with epoll.
+    const char* eventLoop = std::getenv("IRCSERV_EVENT_LOOP");
+
+    // Number of event-loop threads: IRCSERV_THREADS=N, or 0 for one per core.
+    unsigned int threads = 1;
+    if (const char* threadsEnv = std::getenv("IRCSERV_THREADS")) {
+        try {
+            int requested = std::stoi(threadsEnv);
+            if (requested < 0 || requested > 256)
+                throw std::out_of_range("IRCSERV_THREADS");
+            threads = requested ? requested : std::thread::hardware_concurrency();
+        } catch (...) {
+            std::cerr << "Invalid IRCSERV_THREADS (expected 0-256).\n";
+            return EXIT_FAILURE;
+        }
+        if (threads == 0)
+            threads = 1;
+    }
+
+    // Simultaneous connections allowed per IP address: IRCSERV_MAX_PER_IP=N, or 0 for no limit.
+    unsigned int maxPerIp = 64;
+    if (const char* maxPerIpEnv = std::getenv("IRCSERV_MAX_PER_IP")) {
+        try {
+            int requested = std::stoi(maxPerIpEnv);
+            if (requested < 0)
+                throw std::out_of_range("IRCSERV_MAX_PER_IP");
+            maxPerIp = requested;
+        } catch (...) {
+            std::cerr << "Invalid IRCSERV_MAX_PER_IP (expected 0 or more).\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Channel size from which deliveries are spread over all threads: IRCSERV_FANOUT=N, or 0 for never.
+    unsigned int fanout = 1000;
+    if (const char* fanoutEnv = std::getenv("IRCSERV_FANOUT")) {
+        try {
+            int requested = std::stoi(fanoutEnv);
+            if (requested < 0)
+                throw std::out_of_range("IRCSERV_FANOUT");
+            fanout = requested;
+        } catch (...) {
+            std::cerr << "Invalid IRCSERV_FANOUT (expected 0 or more).\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Targets allowed in one PRIVMSG or NOTICE: IRCSERV_MAX_TARGETS=N (at least 1).
+    unsigned int maxTargets = 4;
+    if (const char* maxTargetsEnv = std::getenv("IRCSERV_MAX_TARGETS")) {
+        try {
+            int requested = std::stoi(maxTargetsEnv);
+            if (requested < 1)
+                throw std::out_of_range("IRCSERV_MAX_TARGETS");
+            maxTargets = requested;
+        } catch (...) {
+            std::cerr << "Invalid IRCSERV_MAX_TARGETS (expected 1 or more).\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Log verbosity: IRCSERV_LOG_LEVEL=debug|info|warn|error (info by default).
+    if (const char* levelEnv = std::getenv("IRCSERV_LOG_LEVEL")) {
+        LogLevel level;
+        if (!Logger::parseLevel(levelEnv, level)) {
+            std::cerr << "Invalid IRCSERV_LOG_LEVEL (expected debug, info, warn or error).\n";
+            return EXIT_FAILURE;
+        }
+        Logger::setLevel(level);
+    }
+
+    Logger::start();
+    int status = EXIT_SUCCESS;
     try {
-        Server server(port, password);
+        Server server(port, password, eventLoop ? eventLoop : "", threads);
+        server.setMaxConnectionsPerIp(maxPerIp);
+        server.setFanoutThreshold(fanout);
+        server.setMaxTargets(maxTargets);
         server.run();
     } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << '\n';
-        return EXIT_FAILURE;
+        LOG_ERROR("Error: " << e.what());
+        status = EXIT_FAILURE;
     }
-    return EXIT_SUCCESS;
+    Logger::stop();
+    return status;
 }